@@ -0,0 +1,158 @@
+#pragma once
+
+
+#include "data-processor.h"
+
+
+// Declares a record type from an X-macro field list, along with a decoder and
+// encoder that read and write the fields in order with no runtime format
+// description. The decoder is a straight line of one getter call per field;
+// ProcessingState stays opaque, so the cursor itself (projections, framing
+// modes and heap budgets) is not inlined into it. Supported field types are
+// int, bool, string (a heap copy that TYPE_destroy frees) and view (a
+// zero-copy DataProcessorView).
+//
+//   #define WEATHER_FIELDS(F) F(int, temp) F(string, city) F(bool, rain)
+//
+//   DATA_PROCESSOR_RECORD(Weather, weather, WEATHER_FIELDS)
+//
+// generates:
+//
+//   typedef struct { int temp; char* city; bool rain; } Weather;
+//   void weather_decode(ProcessingState* state, Weather* record);
+//   size_t weather_encode(const Weather* record, char* buffer, size_t cap,
+//                         char delim);
+//   void weather_destroy(Weather* record);
+//
+// The encoder works like snprintf: it returns the full encoded length and the
+// output was truncated if that is cap or more. Values are not escaped, so if
+// any value contains the delimiter nothing is written and the encoder returns
+// DATA_PROCESSOR_RECORD_INVALID instead.
+#define DATA_PROCESSOR_RECORD(TYPE, PREFIX, FIELDS) \
+  typedef struct { \
+    FIELDS(DATA_PROCESSOR_RECORD_MEMBER) \
+  } TYPE; \
+  static inline void PREFIX##_decode(ProcessingState* state, TYPE* record) { \
+    FIELDS(DATA_PROCESSOR_RECORD_DECODE) \
+  } \
+  static inline size_t PREFIX##_encode(const TYPE* record, char* buffer, size_t cap, char delim) { \
+    size_t pos = 0; \
+    bool first = true; \
+    bool valid = true; \
+    FIELDS(DATA_PROCESSOR_RECORD_CHECK) \
+    if (!valid) { \
+      if (cap > 0) { \
+        buffer[0] = '\0'; \
+      } \
+      return DATA_PROCESSOR_RECORD_INVALID; \
+    } \
+    FIELDS(DATA_PROCESSOR_RECORD_ENCODE) \
+    if (cap > 0) { \
+      buffer[pos < cap ? pos : cap - 1] = '\0'; \
+    } \
+    return pos; \
+  } \
+  static inline void PREFIX##_destroy(TYPE* record) { \
+    FIELDS(DATA_PROCESSOR_RECORD_DESTROY) \
+  }
+
+#define DATA_PROCESSOR_RECORD_INVALID SIZE_MAX
+
+#define DATA_PROCESSOR_RECORD_MEMBER(type, name) data_processor_record_type_##type name;
+#define DATA_PROCESSOR_RECORD_DECODE(type, name) record->name = data_processor_record_get_##type(state);
+#define DATA_PROCESSOR_RECORD_CHECK(type, name) \
+  valid = valid && data_processor_record_check_##type(record->name, delim);
+#define DATA_PROCESSOR_RECORD_ENCODE(type, name) \
+  if (!first) { \
+    pos = data_processor_record_put_bytes(buffer, cap, pos, &delim, 1); \
+  } \
+  first = false; \
+  pos = data_processor_record_put_##type(buffer, cap, pos, record->name);
+#define DATA_PROCESSOR_RECORD_DESTROY(type, name) data_processor_record_free_##type(&record->name);
+
+typedef int data_processor_record_type_int;
+typedef bool data_processor_record_type_bool;
+typedef char* data_processor_record_type_string;
+typedef DataProcessorView data_processor_record_type_view;
+
+#define data_processor_record_get_int data_processor_get_int
+#define data_processor_record_get_bool data_processor_get_bool
+#define data_processor_record_get_string data_processor_get_string
+#define data_processor_record_get_view data_processor_get_view
+
+// Writes as much of the bytes as fits while leaving room for the terminator,
+// and returns the position after all of them.
+static inline size_t data_processor_record_put_bytes(char* buffer, size_t cap, size_t pos, const char* bytes, size_t length) {
+  if (pos + 1 < cap) {
+    size_t room = cap - 1 - pos;
+    memcpy(buffer + pos, bytes, length < room ? length : room);
+  }
+  return pos + length;
+}
+
+static inline size_t data_processor_record_put_int(char* buffer, size_t cap, size_t pos, int value) {
+  char digits[12];
+  char* end = digits + sizeof(digits);
+  char* start = end;
+  unsigned int magnitude = value < 0 ? 0u - (unsigned int)value : (unsigned int)value;
+  do {
+    *--start = '0' + (magnitude % 10);
+    magnitude /= 10;
+  } while (magnitude > 0);
+  if (value < 0) {
+    *--start = '-';
+  }
+  return data_processor_record_put_bytes(buffer, cap, pos, start, end - start);
+}
+
+static inline size_t data_processor_record_put_bool(char* buffer, size_t cap, size_t pos, bool value) {
+  return data_processor_record_put_bytes(buffer, cap, pos, value ? "1" : "0", 1);
+}
+
+static inline size_t data_processor_record_put_string(char* buffer, size_t cap, size_t pos, const char* value) {
+  if (NULL == value) {
+    return pos;
+  }
+  return data_processor_record_put_bytes(buffer, cap, pos, value, strlen(value));
+}
+
+static inline size_t data_processor_record_put_view(char* buffer, size_t cap, size_t pos, DataProcessorView value) {
+  if (NULL == value.data) {
+    return pos;
+  }
+  return data_processor_record_put_bytes(buffer, cap, pos, value.data, value.length);
+}
+
+// Checks that a value would not be split by the delimiter when decoded.
+static inline bool data_processor_record_check_int(int value, char delim) {
+  return !((delim >= '0' && delim <= '9') || (delim == '-' && value < 0));
+}
+
+static inline bool data_processor_record_check_bool(bool value, char delim) {
+  return delim != (value ? '1' : '0');
+}
+
+static inline bool data_processor_record_check_string(const char* value, char delim) {
+  return NULL == value || NULL == memchr(value, delim, strlen(value));
+}
+
+static inline bool data_processor_record_check_view(DataProcessorView value, char delim) {
+  return NULL == value.data || NULL == memchr(value.data, delim, value.length);
+}
+
+static inline void data_processor_record_free_int(int* value) {
+  (void)value;
+}
+
+static inline void data_processor_record_free_bool(bool* value) {
+  (void)value;
+}
+
+static inline void data_processor_record_free_string(char** value) {
+  free(*value);
+  *value = NULL;
+}
+
+static inline void data_processor_record_free_view(DataProcessorView* value) {
+  (void)value;
+}
@@ -5,14 +5,131 @@
 
 
 typedef struct ProcessingState ProcessingState;
+typedef struct DataProcessorInternTable DataProcessorInternTable;
+typedef struct DataProcessorStream DataProcessorStream;
+typedef struct DataProcessorJob DataProcessorJob;
+typedef struct DataProcessorPool DataProcessorPool;
+typedef struct DataProcessorSwap DataProcessorSwap;
+typedef struct DataProcessorRecordIndex DataProcessorRecordIndex;
+
+typedef enum {
+  DATA_PROCESSOR_OK = 0,
+  DATA_PROCESSOR_ERROR_NULL_STATE,
+  DATA_PROCESSOR_ERROR_OUT_OF_BUDGET,
+  DATA_PROCESSOR_ERROR_OUT_OF_MEMORY,
+  DATA_PROCESSOR_ERROR_FIELD_TOO_LONG,
+  DATA_PROCESSOR_ERROR_OUT_OF_ORDER,
+  DATA_PROCESSOR_ERROR_MALFORMED,
+} DataProcessorStatus;
+
+typedef struct {
+  const char* data;
+  size_t length;
+} DataProcessorView;
+
+typedef enum {
+  DATA_PROCESSOR_FIELD_STRING,
+  DATA_PROCESSOR_FIELD_INT,
+  DATA_PROCESSOR_FIELD_BOOL,
+  DATA_PROCESSOR_FIELD_FIXED,
+} DataProcessorFieldType;
+
+typedef struct {
+  DataProcessorFieldType type;
+  uint16_t max_length;
+  uint8_t scale;
+  int32_t min;
+  int32_t max;
+} DataProcessorField;
+
+typedef struct {
+  const DataProcessorField* fields;
+  uint8_t num_fields;
+} DataProcessorSchema;
+
+typedef struct {
+  uint32_t seq;
+  uint32_t data;
+  uint32_t last;
+  uint32_t status;
+} DataProcessorStreamKeys;
+
+typedef void (*DataProcessorFieldHandler)(ProcessingState* field, uint16_t index, void* context);
+typedef void (*DataProcessorCompleteHandler)(ProcessingState* state, void* context);
+typedef bool (*DataProcessorDecodeHandler)(ProcessingState* state, void* values, void* context);
+typedef void (*DataProcessorReleaseHandler)(void* values, void* context);
+
+typedef struct {
+  char* pos;
+  uint8_t record_field;
+  uint8_t column;
+  bool exhausted;
+} ProcessingCheckpoint;
 
 
 void data_processor_init(char* data, char delim);
 ProcessingState* data_processor_create(char* data, char delim);
+ProcessingState* data_processor_create_with_length(char* data, size_t length, char delim);
+ProcessingState* data_processor_create_with_delimiters(char* data, const char* delims);
+ProcessingState* data_processor_create_fixed_width(char* data, const uint8_t* widths, uint8_t num_widths);
+ProcessingState* data_processor_create_length_prefixed(char* data);
+ProcessingState* data_processor_create_from_tuple(const Tuple* tuple, char delim);
+ProcessingState* data_processor_create_from_dict(const DictionaryIterator* iter, uint32_t key, char delim);
+uint32_t data_processor_inbox_size(const DataProcessorSchema* schema);
 void data_processor_destroy(ProcessingState* state);
 void data_processor_deinit();
 ProcessingState* data_processor_get_global(void);
 uint8_t data_processor_count(ProcessingState* state);
+bool data_processor_has_next(ProcessingState* state);
+size_t data_processor_remaining_bytes(ProcessingState* state);
+int data_processor_validate(ProcessingState* state, const DataProcessorSchema* schema);
+bool data_processor_validate_utf8(ProcessingState* state);
+ProcessingCheckpoint data_processor_save(ProcessingState* state);
+void data_processor_restore(ProcessingState* state, ProcessingCheckpoint checkpoint);
+void data_processor_rewind(ProcessingState* state);
+void data_processor_set_projection(ProcessingState* state, uint8_t fields_per_record, uint32_t mask);
+bool data_processor_seek(ProcessingState* state, uint16_t field);
+void data_processor_skip(ProcessingState* state, uint16_t count);
+void data_processor_set_heap_budget(ProcessingState* state, size_t budget);
+size_t data_processor_get_heap_used(ProcessingState* state);
+void data_processor_free_string(ProcessingState* state, char* str);
+DataProcessorStatus data_processor_get_status(ProcessingState* state);
 char* data_processor_get_string(ProcessingState* state);
+char* data_processor_get_string_truncated(ProcessingState* state, size_t max_chars);
+DataProcessorView data_processor_get_view(ProcessingState* state);
+size_t data_processor_get_string_into(ProcessingState* state, char* dst, size_t cap);
+DataProcessorPool* data_processor_pool_create(void);
+void data_processor_pool_destroy(DataProcessorPool* pool);
+void data_processor_set_pool(ProcessingState* state, DataProcessorPool* pool);
+void data_processor_pool_release(DataProcessorPool* pool, char* str);
+DataProcessorInternTable* data_processor_intern_create(uint16_t capacity);
+void data_processor_intern_destroy(DataProcessorInternTable* table);
+const char* data_processor_get_string_interned(ProcessingState* state, DataProcessorInternTable* table);
 bool data_processor_get_bool(ProcessingState* state);
+uint32_t data_processor_get_bools(ProcessingState* state, uint8_t count);
 int data_processor_get_int(ProcessingState* state);
+int32_t data_processor_get_fixed(ProcessingState* state, uint8_t scale);
+int data_processor_get_base64_into(ProcessingState* state, uint8_t* dst, size_t cap);
+int data_processor_get_hex_into(ProcessingState* state, uint8_t* dst, size_t cap);
+DataProcessorStream* data_processor_stream_create(char delim, uint16_t max_field_length, DataProcessorFieldHandler handler, void* context);
+DataProcessorStream* data_processor_stream_create_compressed(char delim, uint16_t max_field_length, DataProcessorFieldHandler handler, void* context);
+void data_processor_stream_destroy(DataProcessorStream* stream);
+void data_processor_stream_reset(DataProcessorStream* stream);
+bool data_processor_stream_feed(DataProcessorStream* stream, uint16_t seq, const uint8_t* data, size_t length, bool last);
+bool data_processor_stream_handle_message(DataProcessorStream* stream, const DictionaryIterator* iter, const DataProcessorStreamKeys* keys);
+bool data_processor_stream_is_complete(DataProcessorStream* stream);
+DataProcessorStatus data_processor_stream_get_status(DataProcessorStream* stream);
+DataProcessorJob* data_processor_parse_async(ProcessingState* state, uint16_t max_fields, uint16_t max_ms, DataProcessorFieldHandler handler, DataProcessorCompleteHandler complete, void* context);
+void data_processor_job_cancel(DataProcessorJob* job);
+DataProcessorSwap* data_processor_swap_create(size_t values_size, DataProcessorDecodeHandler decode, DataProcessorReleaseHandler release, void* context);
+void data_processor_swap_destroy(DataProcessorSwap* swap);
+bool data_processor_swap_update(DataProcessorSwap* swap, const char* data, size_t length, char delim);
+void data_processor_swap_publish(DataProcessorSwap* swap);
+const void* data_processor_swap_front(DataProcessorSwap* swap);
+DataProcessorRecordIndex* data_processor_record_index_create(ProcessingState* state, uint8_t fields_per_record, uint8_t key_field);
+void data_processor_record_index_destroy(DataProcessorRecordIndex* index);
+uint16_t data_processor_record_index_count(DataProcessorRecordIndex* index);
+uint16_t data_processor_record_index_lower_bound(DataProcessorRecordIndex* index, const char* key, size_t length);
+int data_processor_record_index_find(DataProcessorRecordIndex* index, const char* key);
+DataProcessorView data_processor_record_index_key(DataProcessorRecordIndex* index, uint16_t position);
+bool data_processor_record_index_seek(DataProcessorRecordIndex* index, uint16_t position);
@@ -0,0 +1,32 @@
+#include <pebble.h>
+#include "data-processor-internal.h"
+
+
+ProcessingState* data_processor_create_from_tuple(const Tuple* tuple, char delim) {
+  if (NULL == tuple) {
+    return NULL;
+  }
+  // Index through a pointer rather than the SDK's zero-length array member.
+  const char* cstring = tuple->value->cstring;
+  size_t length = tuple->length;
+  switch (tuple->type) {
+    case TUPLE_CSTRING:
+      // The length includes the terminator, but be defensive about it.
+      while (length > 0 && cstring[length - 1] == '\0') {
+        length -= 1;
+      }
+      break;
+    case TUPLE_BYTE_ARRAY:
+      break;
+    default:
+      return NULL;
+  }
+  return data_processor_create_with_length((char*)cstring, length, delim);
+}
+
+ProcessingState* data_processor_create_from_dict(const DictionaryIterator* iter, uint32_t key, char delim) {
+  if (NULL == iter) {
+    return NULL;
+  }
+  return data_processor_create_from_tuple(dict_find(iter, key), delim);
+}
@@ -0,0 +1,103 @@
+#include <pebble.h>
+#include "data-processor-internal.h"
+
+
+// Delay between the steps of a time-sliced parse, giving queued button and
+// animation events a chance to run.
+#ifndef DATA_PROCESSOR_JOB_INTERVAL
+#define DATA_PROCESSOR_JOB_INTERVAL 10
+#endif
+
+struct DataProcessorJob {
+  ProcessingState* state;
+  uint16_t max_fields;
+  uint16_t max_ms;
+  DataProcessorFieldHandler handler;
+  DataProcessorCompleteHandler complete;
+  void* context;
+  uint16_t field_index;
+  AppTimer* timer;
+  // Set while handlers are being called, when a cancel has to be deferred
+  // until they return.
+  bool running;
+  bool cancelled;
+  ProcessingState field;
+};
+
+
+static void job_step(void* data);
+static uint32_t now_ms(void);
+
+
+DataProcessorJob* data_processor_parse_async(ProcessingState* state, uint16_t max_fields, uint16_t max_ms, DataProcessorFieldHandler handler, DataProcessorCompleteHandler complete, void* context) {
+  if (NULL == state || NULL == handler) {
+    return NULL;
+  }
+  DataProcessorJob* job = malloc(sizeof(DataProcessorJob));
+  if (NULL == job) {
+    return NULL;
+  }
+  job->state = state;
+  job->max_fields = max_fields > 0 ? max_fields : 1;
+  job->max_ms = max_ms;
+  job->handler = handler;
+  job->complete = complete;
+  job->context = context;
+  job->field_index = 0;
+  job->running = false;
+  job->cancelled = false;
+  job->timer = app_timer_register(0, job_step, job);
+  return job;
+}
+
+void data_processor_job_cancel(DataProcessorJob* job) {
+  if (NULL == job) {
+    return;
+  }
+  if (job->running) {
+    job->cancelled = true;
+    return;
+  }
+  app_timer_cancel(job->timer);
+  free(job);
+}
+
+// Parses up to max_fields fields, stopping early once max_ms have passed, then
+// either schedules the next step or finishes the job.
+static void job_step(void* data) {
+  DataProcessorJob* job = data;
+  uint32_t start = now_ms();
+  uint16_t fields = 0;
+  job->running = true;
+  while (!job->state->exhausted && fields < job->max_fields) {
+    size_t length;
+    char* field = dp_next_field(job->state, &length);
+    dp_init_field_state(&job->field, field, length, job->state->data_delim);
+    job->handler(&job->field, job->field_index, job->context);
+    if (job->cancelled) {
+      free(job);
+      return;
+    }
+    job->field_index += 1;
+    fields += 1;
+    if (job->max_ms > 0 && now_ms() - start >= job->max_ms) {
+      break;
+    }
+  }
+  if (!job->state->exhausted) {
+    job->running = false;
+    job->timer = app_timer_register(DATA_PROCESSOR_JOB_INTERVAL, job_step, job);
+    return;
+  }
+  // The job stays valid (and cancelling it does nothing) until complete returns.
+  if (NULL != job->complete) {
+    job->complete(job->state, job->context);
+  }
+  free(job);
+}
+
+static uint32_t now_ms(void) {
+  time_t seconds;
+  uint16_t ms = time_ms(&seconds, NULL);
+  return (uint32_t)seconds * 1000 + ms;
+}
@@ -0,0 +1,215 @@
+#include <pebble.h>
+#include "data-processor-internal.h"
+
+
+static const uint8_t BASE64_DECODE[256] = {
+  0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+  0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+  0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0x3E, 0xFF, 0xFF, 0xFF, 0x3F,
+  0x34, 0x35, 0x36, 0x37, 0x38, 0x39, 0x3A, 0x3B, 0x3C, 0x3D, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+  0xFF, 0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0A, 0x0B, 0x0C, 0x0D, 0x0E,
+  0x0F, 0x10, 0x11, 0x12, 0x13, 0x14, 0x15, 0x16, 0x17, 0x18, 0x19, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+  0xFF, 0x1A, 0x1B, 0x1C, 0x1D, 0x1E, 0x1F, 0x20, 0x21, 0x22, 0x23, 0x24, 0x25, 0x26, 0x27, 0x28,
+  0x29, 0x2A, 0x2B, 0x2C, 0x2D, 0x2E, 0x2F, 0x30, 0x31, 0x32, 0x33, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+  0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+  0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+  0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+  0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+  0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+  0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+  0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+  0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+};
+
+// Indexed by character - '0', covering '0' to 'f'.
+static const uint8_t HEX_DECODE[55] = {
+  0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+  0xFF, 0x0A, 0x0B, 0x0C, 0x0D, 0x0E, 0x0F, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+  0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+  0xFF, 0x0A, 0x0B, 0x0C, 0x0D, 0x0E, 0x0F,
+};
+
+static int decode_base64(const char* field, size_t length, uint8_t* dst, size_t cap);
+static int decode_hex(const char* field, size_t length, uint8_t* dst, size_t cap);
+static int32_t parse_fixed(const char* field, size_t length, uint8_t scale);
+
+
+uint32_t data_processor_get_bools(ProcessingState* state, uint8_t count) {
+  if (NULL == state) {
+    return 0;
+  }
+  if (count > 32) {
+    count = 32;
+  }
+  uint32_t bits = 0;
+  for (uint8_t n = 0; n < count; n += 1) {
+    size_t length;
+    char* field = dp_next_field(state, &length);
+    if (dp_parse_bool(field, length)) {
+      bits |= (uint32_t)1 << n;
+    }
+  }
+  return bits;
+}
+
+int32_t data_processor_get_fixed(ProcessingState* state, uint8_t scale) {
+  if (NULL == state) {
+    return 0;
+  }
+  size_t length;
+  char* field = dp_next_field(state, &length);
+  return parse_fixed(field, length, scale);
+}
+
+int data_processor_get_base64_into(ProcessingState* state, uint8_t* dst, size_t cap) {
+  if (NULL == state) {
+    return -1;
+  }
+  size_t length;
+  char* field = dp_next_field(state, &length);
+  return decode_base64(field, length, dst, cap);
+}
+
+int data_processor_get_hex_into(ProcessingState* state, uint8_t* dst, size_t cap) {
+  if (NULL == state) {
+    return -1;
+  }
+  size_t length;
+  char* field = dp_next_field(state, &length);
+  return decode_hex(field, length, dst, cap);
+}
+
+// Decodes one 4 character quantum at a time. Trailing padding is optional.
+// Returns the number of bytes written, or -1 if the field is malformed or does
+// not fit in cap bytes.
+static int decode_base64(const char* field, size_t length, uint8_t* dst, size_t cap) {
+  const uint8_t* src = (const uint8_t*)field;
+  while (length > 0 && src[length - 1] == '=') {
+    length -= 1;
+  }
+  if (length % 4 == 1) {
+    return -1;
+  }
+  size_t out_len = (length / 4) * 3 + ((length % 4) ? (length % 4) - 1 : 0);
+  if (out_len > cap) {
+    return -1;
+  }
+  const uint8_t* end = src + (length & ~(size_t)3);
+  uint8_t* out = dst;
+  while (src < end) {
+    uint8_t a = BASE64_DECODE[src[0]];
+    uint8_t b = BASE64_DECODE[src[1]];
+    uint8_t c = BASE64_DECODE[src[2]];
+    uint8_t d = BASE64_DECODE[src[3]];
+    if ((a | b | c | d) & 0xC0) {
+      return -1;
+    }
+    uint32_t quantum = (a << 18) | (b << 12) | (c << 6) | d;
+    out[0] = quantum >> 16;
+    out[1] = quantum >> 8;
+    out[2] = quantum;
+    src += 4;
+    out += 3;
+  }
+  if (length % 4) {
+    uint8_t a = BASE64_DECODE[src[0]];
+    uint8_t b = BASE64_DECODE[src[1]];
+    uint8_t c = (length % 4 == 3) ? BASE64_DECODE[src[2]] : 0;
+    if ((a | b | c) & 0xC0) {
+      return -1;
+    }
+    uint32_t quantum = (a << 18) | (b << 12) | (c << 6);
+    *out++ = quantum >> 16;
+    if (length % 4 == 3) {
+      *out++ = quantum >> 8;
+    }
+  }
+  return out_len;
+}
+
+static int decode_hex(const char* field, size_t length, uint8_t* dst, size_t cap) {
+  if (length % 2 != 0 || length / 2 > cap) {
+    return -1;
+  }
+  const uint8_t* src = (const uint8_t*)field;
+  for (size_t n = 0; n < length / 2; n += 1) {
+    uint8_t hi = (uint8_t)(src[0] - '0');
+    uint8_t lo = (uint8_t)(src[1] - '0');
+    if (hi >= sizeof(HEX_DECODE) || lo >= sizeof(HEX_DECODE)) {
+      return -1;
+    }
+    hi = HEX_DECODE[hi];
+    lo = HEX_DECODE[lo];
+    if ((hi | lo) & 0xF0) {
+      return -1;
+    }
+    dst[n] = (hi << 4) | lo;
+    src += 2;
+  }
+  return length / 2;
+}
+
+// Parses a decimal such as "-12.345" into an integer scaled by 10^scale,
+// rounding half away from zero and saturating at the int32_t limits.
+static int32_t parse_fixed(const char* field, size_t length, uint8_t scale) {
+  int64_t value = dp_parse_scaled(field, length, scale);
+  if (value > INT32_MAX) {
+    return INT32_MAX;
+  }
+  if (value < INT32_MIN) {
+    return INT32_MIN;
+  }
+  return (int32_t)value;
+}
+
+// As parse_fixed, but values just past the int32_t limits are returned as is so
+// that overflow can be detected.
+int64_t dp_parse_scaled(const char* field, size_t length, uint8_t scale) {
+  const char* pos = field;
+  const char* end = field + length;
+  bool negative = false;
+  if (pos < end && (*pos == '-' || *pos == '+')) {
+    negative = (*pos == '-');
+    pos++;
+  }
+  if (scale > 9) {
+    scale = 9;
+  }
+  const uint64_t limit = (uint64_t)INT32_MAX + 2;
+  uint64_t value = 0;
+  while (pos < end && *pos >= '0' && *pos <= '9') {
+    if (value <= limit) {
+      value = value * 10 + (*pos - '0');
+    }
+    pos++;
+  }
+  uint8_t decimals = 0;
+  bool round_up = false;
+  if (pos < end && *pos == '.') {
+    pos++;
+    while (pos < end && *pos >= '0' && *pos <= '9') {
+      if (decimals < scale) {
+        if (value <= limit) {
+          value = value * 10 + (*pos - '0');
+        }
+        decimals += 1;
+      } else if (decimals == scale) {
+        round_up = (*pos >= '5');
+        decimals += 1;
+      }
+      pos++;
+    }
+  }
+  for (; decimals < scale; decimals += 1) {
+    if (value <= limit) {
+      value *= 10;
+    }
+  }
+  if (round_up) {
+    value += 1;
+  }
+  if (value > limit) {
+    value = limit;
+  }
+  return negative ? -(int64_t)value : (int64_t)value;
+}
@@ -0,0 +1,104 @@
+#include <pebble.h>
+#include "data-processor-internal.h"
+
+
+typedef struct {
+  uint32_t hash;
+  uint16_t length;
+  char* str;
+} InternSlot;
+
+struct DataProcessorInternTable {
+  uint16_t capacity;
+  uint16_t count;
+  uint16_t mask;
+  InternSlot* slots;
+};
+
+
+static uint32_t hash_field(const char* field, size_t length);
+
+
+DataProcessorInternTable* data_processor_intern_create(uint16_t capacity) {
+  if (capacity == 0 || capacity > 0x4000) {
+    return NULL;
+  }
+  // Keep the load factor at or below one half so probe sequences stay short.
+  uint16_t num_slots = 1;
+  while (num_slots < capacity * 2) {
+    num_slots <<= 1;
+  }
+  DataProcessorInternTable* table = malloc(sizeof(DataProcessorInternTable));
+  if (NULL == table) {
+    return NULL;
+  }
+  table->slots = calloc(num_slots, sizeof(InternSlot));
+  if (NULL == table->slots) {
+    free(table);
+    return NULL;
+  }
+  table->capacity = capacity;
+  table->count = 0;
+  table->mask = num_slots - 1;
+  return table;
+}
+
+void data_processor_intern_destroy(DataProcessorInternTable* table) {
+  if (NULL == table) {
+    return;
+  }
+  for (uint32_t n = 0; n <= table->mask; n += 1) {
+    free(table->slots[n].str);
+  }
+  free(table->slots);
+  free(table);
+}
+
+const char* data_processor_get_string_interned(ProcessingState* state, DataProcessorInternTable* table) {
+  if (NULL == state || NULL == table) {
+    return NULL;
+  }
+  ProcessingCheckpoint checkpoint = data_processor_save(state);
+  size_t length;
+  char* field = dp_next_field(state, &length);
+  if (length > UINT16_MAX) {
+    data_processor_restore(state, checkpoint);
+    return NULL;
+  }
+  uint32_t hash = hash_field(field, length);
+  uint16_t slot = hash & table->mask;
+  while (NULL != table->slots[slot].str) {
+    InternSlot* entry = &table->slots[slot];
+    if (entry->hash == hash && entry->length == length && memcmp(entry->str, field, length) == 0) {
+      return entry->str;
+    }
+    slot = (slot + 1) & table->mask;
+  }
+  // Interned strings count against the budget of the state that adds them.
+  if (table->count >= table->capacity || !dp_budget_allows(state, length + 1)) {
+    data_processor_restore(state, checkpoint);
+    return NULL;
+  }
+  char* str = malloc(length + 1);
+  if (NULL == str) {
+    state->status = DATA_PROCESSOR_ERROR_OUT_OF_MEMORY;
+    data_processor_restore(state, checkpoint);
+    return NULL;
+  }
+  state->heap_used += length + 1;
+  memcpy(str, field, length);
+  str[length] = '\0';
+  table->slots[slot] = (InternSlot) { .hash = hash, .length = length, .str = str };
+  table->count += 1;
+  return str;
+}
+
+// 32-bit FNV-1a.
+static uint32_t hash_field(const char* field, size_t length) {
+  uint32_t hash = 2166136261u;
+  for (size_t n = 0; n < length; n += 1) {
+    hash ^= (uint8_t)field[n];
+    hash *= 16777619u;
+  }
+  return hash;
+}
@@ -0,0 +1,51 @@
+#pragma once
+
+
+#include <pebble.h>
+#include "data-processor.h"
+
+
+// Shared between the separately compiled parts of the library. Not bundled
+// with the public headers.
+
+struct ProcessingState {
+  char* data_start;
+  char* data_pos;
+  char* data_end;
+  char data_delim;
+  // When set, a bitmap of every byte that is a delimiter, replacing data_delim.
+  uint32_t* delim_set;
+  DataProcessorPool* pool;
+  // Set along with pool, so that the core only uses the pool when it is built.
+  char* (*pool_alloc)(DataProcessorPool* pool, size_t size);
+  // pool_release returns the size the string was allocated with.
+  size_t (*pool_release)(DataProcessorPool* pool, char* str);
+  // Fields whose bit is clear in the projection are skipped by the getters.
+  // record_field is the position of the cursor within the current record.
+  uint32_t projection;
+  uint8_t record_fields;
+  uint8_t record_field;
+  // Set for fixed-width states: the offset of each field within a record,
+  // followed by the width of the whole record. column is the field within the
+  // record at the cursor.
+  uint16_t* field_offsets;
+  uint8_t num_widths;
+  uint8_t column;
+  // Set when every field is preceded by its length and a colon.
+  bool length_prefixed;
+  bool exhausted;
+  DataProcessorStatus status;
+  size_t heap_budget;
+  size_t heap_used;
+};
+
+void dp_init_state(ProcessingState* state, char* data, size_t length, char delim);
+char* dp_field_at(const ProcessingState* state, char* pos, size_t* length);
+char* dp_next_field(ProcessingState* state, size_t* length);
+uint8_t dp_column_at(const ProcessingState* state, const char* pos);
+char* dp_read_field(ProcessingState* state, size_t* length);
+bool dp_budget_allows(ProcessingState* state, size_t size);
+char* dp_alloc_string(ProcessingState* state, size_t length);
+bool dp_parse_bool(const char* field, size_t length);
+int64_t dp_parse_scaled(const char* field, size_t length, uint8_t scale);
+void dp_init_field_state(ProcessingState* field, char* data, size_t length, char delim);
@@ -0,0 +1,117 @@
+#include <pebble.h>
+#include <stddef.h>
+#include "data-processor-internal.h"
+
+
+// String pool size classes, in bytes including the terminator.
+#define POOL_NUM_CLASSES 5
+#define POOL_MIN_CLASS_SIZE 16
+
+typedef struct PoolBlock {
+  union {
+    // Set while the block is on a free list.
+    struct PoolBlock* next;
+    // Set while the block holds a string: the size asked for, which the class
+    // is worked out from again on release.
+    uint32_t size;
+  } header;
+  char data[];
+} PoolBlock;
+
+struct DataProcessorPool {
+  PoolBlock* free_lists[POOL_NUM_CLASSES];
+};
+
+
+static uint8_t pool_class(size_t size);
+static char* pool_alloc(DataProcessorPool* pool, size_t size);
+static size_t pool_free(DataProcessorPool* pool, char* str);
+
+
+DataProcessorPool* data_processor_pool_create(void) {
+  DataProcessorPool* pool = malloc(sizeof(DataProcessorPool));
+  if (NULL == pool) {
+    return NULL;
+  }
+  memset(pool, 0, sizeof(DataProcessorPool));
+  return pool;
+}
+
+void data_processor_pool_destroy(DataProcessorPool* pool) {
+  if (NULL == pool) {
+    return;
+  }
+  for (uint8_t n = 0; n < POOL_NUM_CLASSES; n += 1) {
+    PoolBlock* block = pool->free_lists[n];
+    while (NULL != block) {
+      PoolBlock* next = block->header.next;
+      free(block);
+      block = next;
+    }
+  }
+  free(pool);
+}
+
+void data_processor_set_pool(ProcessingState* state, DataProcessorPool* pool) {
+  if (NULL == state) {
+    return;
+  }
+  state->pool = pool;
+  state->pool_alloc = pool_alloc;
+  state->pool_release = pool_free;
+}
+
+void data_processor_pool_release(DataProcessorPool* pool, char* str) {
+  if (NULL == pool || NULL == str) {
+    return;
+  }
+  pool_free(pool, str);
+}
+
+// The smallest class whose blocks fit size bytes, or POOL_NUM_CLASSES if none
+// do.
+static uint8_t pool_class(size_t size) {
+  uint8_t size_class = 0;
+  size_t class_size = POOL_MIN_CLASS_SIZE;
+  while (size_class < POOL_NUM_CLASSES && class_size < size) {
+    size_class += 1;
+    class_size <<= 1;
+  }
+  return size_class;
+}
+
+// Takes a block of the smallest class that fits from its free list, or mallocs
+// one if the list is empty. Strings too big for every class get a block of
+// their own size, which is freed again on release.
+static char* pool_alloc(DataProcessorPool* pool, size_t size) {
+  uint8_t size_class = pool_class(size);
+  PoolBlock* block;
+  if (size_class == POOL_NUM_CLASSES) {
+    block = malloc(sizeof(PoolBlock) + size);
+  } else if (NULL != pool->free_lists[size_class]) {
+    block = pool->free_lists[size_class];
+    pool->free_lists[size_class] = block->header.next;
+  } else {
+    block = malloc(sizeof(PoolBlock) + ((size_t)POOL_MIN_CLASS_SIZE << size_class));
+  }
+  if (NULL == block) {
+    return NULL;
+  }
+  block->header.size = size;
+  return block->data;
+}
+
+// Puts a string's block back on the free list of its class, or frees it if it
+// was too big for every class. Returns the size the string was allocated with.
+static size_t pool_free(DataProcessorPool* pool, char* str) {
+  PoolBlock* block = (PoolBlock*)(str - offsetof(PoolBlock, data));
+  size_t size = block->header.size;
+  uint8_t size_class = pool_class(size);
+  if (size_class == POOL_NUM_CLASSES) {
+    free(block);
+    return size;
+  }
+  block->header.next = pool->free_lists[size_class];
+  pool->free_lists[size_class] = block;
+  return size;
+}
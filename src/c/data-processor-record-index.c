@@ -0,0 +1,185 @@
+#include <pebble.h>
+#include "data-processor-internal.h"
+
+
+typedef struct {
+  uint16_t record;
+  uint16_t key;
+} IndexEntry;
+
+struct DataProcessorRecordIndex {
+  ProcessingState* state;
+  uint16_t count;
+  // Offsets from the start of the data, sorted by key.
+  IndexEntry* entries;
+};
+
+
+static int compare_keys(const DataProcessorRecordIndex* index, uint16_t key, const char* other, size_t other_len);
+static int compare_entries(const DataProcessorRecordIndex* index, uint16_t a, uint16_t b);
+static void sift_down(DataProcessorRecordIndex* index, uint16_t root, uint16_t count);
+
+
+DataProcessorRecordIndex* data_processor_record_index_create(ProcessingState* state, uint8_t fields_per_record, uint8_t key_field) {
+  if (NULL == state || fields_per_record == 0 || key_field >= fields_per_record) {
+    return NULL;
+  }
+  if (state->data_end - state->data_start > UINT16_MAX) {
+    return NULL;
+  }
+  // First pass counts the records that have a key, second pass records them.
+  DataProcessorRecordIndex* index = malloc(sizeof(DataProcessorRecordIndex));
+  if (NULL == index) {
+    return NULL;
+  }
+  index->state = state;
+  index->count = 0;
+  index->entries = NULL;
+  for (uint8_t pass = 0; pass < 2; pass += 1) {
+    ProcessingState scan = *state;
+    data_processor_rewind(&scan);
+    uint16_t count = 0;
+    while (!scan.exhausted && count < UINT16_MAX) {
+      char* record = scan.data_pos;
+      size_t length;
+      for (uint8_t n = 0; n < key_field && !scan.exhausted; n += 1) {
+        dp_read_field(&scan, &length);
+      }
+      if (scan.exhausted) {
+        break;
+      }
+      char* key = scan.data_pos;
+      dp_read_field(&scan, &length);
+      for (uint8_t n = key_field + 1; n < fields_per_record && !scan.exhausted; n += 1) {
+        dp_read_field(&scan, &length);
+      }
+      if (NULL != index->entries) {
+        index->entries[count].record = record - state->data_start;
+        index->entries[count].key = key - state->data_start;
+      }
+      count += 1;
+    }
+    if (NULL == index->entries) {
+      index->count = count;
+      index->entries = malloc(sizeof(IndexEntry) * (count > 0 ? count : 1));
+      if (NULL == index->entries) {
+        free(index);
+        return NULL;
+      }
+    }
+  }
+  // Heapsort, to sort in place without recursion.
+  for (uint16_t n = index->count / 2; n > 0; n -= 1) {
+    sift_down(index, n - 1, index->count);
+  }
+  for (uint16_t end = index->count; end > 1; end -= 1) {
+    IndexEntry top = index->entries[0];
+    index->entries[0] = index->entries[end - 1];
+    index->entries[end - 1] = top;
+    sift_down(index, 0, end - 1);
+  }
+  return index;
+}
+
+void data_processor_record_index_destroy(DataProcessorRecordIndex* index) {
+  if (NULL == index) {
+    return;
+  }
+  free(index->entries);
+  free(index);
+}
+
+uint16_t data_processor_record_index_count(DataProcessorRecordIndex* index) {
+  if (NULL == index) {
+    return 0;
+  }
+  return index->count;
+}
+
+uint16_t data_processor_record_index_lower_bound(DataProcessorRecordIndex* index, const char* key, size_t length) {
+  if (NULL == index || NULL == key) {
+    return 0;
+  }
+  uint16_t low = 0;
+  uint16_t high = index->count;
+  while (low < high) {
+    uint16_t mid = low + (high - low) / 2;
+    if (compare_keys(index, index->entries[mid].key, key, length) < 0) {
+      low = mid + 1;
+    } else {
+      high = mid;
+    }
+  }
+  return low;
+}
+
+int data_processor_record_index_find(DataProcessorRecordIndex* index, const char* key) {
+  if (NULL == index || NULL == key) {
+    return -1;
+  }
+  size_t length = strlen(key);
+  uint16_t position = data_processor_record_index_lower_bound(index, key, length);
+  if (position < index->count && compare_keys(index, index->entries[position].key, key, length) == 0) {
+    return position;
+  }
+  return -1;
+}
+
+DataProcessorView data_processor_record_index_key(DataProcessorRecordIndex* index, uint16_t position) {
+  if (NULL == index || position >= index->count) {
+    return (DataProcessorView) { .data = NULL, .length = 0 };
+  }
+  size_t length;
+  char* key = dp_field_at(index->state, index->state->data_start + index->entries[position].key, &length);
+  return (DataProcessorView) { .data = key, .length = length };
+}
+
+bool data_processor_record_index_seek(DataProcessorRecordIndex* index, uint16_t position) {
+  if (NULL == index || position >= index->count) {
+    return false;
+  }
+  index->state->data_pos = index->state->data_start + index->entries[position].record;
+  index->state->record_field = 0;
+  if (NULL != index->state->field_offsets) {
+    index->state->column = dp_column_at(index->state, index->state->data_pos);
+  }
+  index->state->exhausted = false;
+  return true;
+}
+
+// Byte-wise comparison, with a key that is a prefix of another sorting first.
+static int compare_keys(const DataProcessorRecordIndex* index, uint16_t key, const char* other, size_t other_len) {
+  size_t length;
+  char* start = dp_field_at(index->state, index->state->data_start + key, &length);
+  int result = memcmp(start, other, length < other_len ? length : other_len);
+  if (result != 0) {
+    return result;
+  }
+  return (length > other_len) - (length < other_len);
+}
+
+static int compare_entries(const DataProcessorRecordIndex* index, uint16_t a, uint16_t b) {
+  size_t other_len;
+  char* other = dp_field_at(index->state, index->state->data_start + index->entries[b].key, &other_len);
+  return compare_keys(index, index->entries[a].key, other, other_len);
+}
+
+static void sift_down(DataProcessorRecordIndex* index, uint16_t root, uint16_t count) {
+  IndexEntry* entries = index->entries;
+  for (;;) {
+    uint32_t child = (uint32_t)root * 2 + 1;
+    if (child >= count) {
+      return;
+    }
+    if (child + 1 < count && compare_entries(index, child, child + 1) < 0) {
+      child += 1;
+    }
+    if (compare_entries(index, root, child) >= 0) {
+      return;
+    }
+    IndexEntry tmp = entries[root];
+    entries[root] = entries[child];
+    entries[child] = tmp;
+    root = child;
+  }
+}
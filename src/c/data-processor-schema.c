@@ -0,0 +1,100 @@
+#include <pebble.h>
+#include "data-processor-internal.h"
+
+
+static uint16_t field_max_length(const DataProcessorField* field);
+static bool valid_field(const DataProcessorField* spec, const char* field, size_t length);
+
+
+uint32_t data_processor_inbox_size(const DataProcessorSchema* schema) {
+  if (NULL == schema) {
+    return 0;
+  }
+  // The payload holds every field, a delimiter between each pair and a NUL.
+  uint32_t payload = schema->num_fields > 0 ? schema->num_fields : 1;
+  for (uint8_t n = 0; n < schema->num_fields; n += 1) {
+    payload += field_max_length(&schema->fields[n]);
+  }
+  return dict_calc_buffer_size(1, payload);
+}
+
+int data_processor_validate(ProcessingState* state, const DataProcessorSchema* schema) {
+  if (NULL == state || NULL == schema) {
+    return 0;
+  }
+  // Scan a copy so the cursor of the real state does not move.
+  ProcessingState scan = *state;
+  uint8_t index = 0;
+  while (!scan.exhausted) {
+    if (index >= schema->num_fields) {
+      return index;
+    }
+    size_t length;
+    char* field = dp_read_field(&scan, &length);
+    if (!valid_field(&schema->fields[index], field, length)) {
+      return index;
+    }
+    index += 1;
+  }
+  return index < schema->num_fields ? index : -1;
+}
+
+// The longest text a field can hold. Numeric and bool fields default to the
+// longest value of their type when no max_length is given.
+static uint16_t field_max_length(const DataProcessorField* field) {
+  if (field->max_length > 0) {
+    return field->max_length;
+  }
+  switch (field->type) {
+    case DATA_PROCESSOR_FIELD_INT:
+      return 11;  // -2147483648
+    case DATA_PROCESSOR_FIELD_BOOL:
+      return 5;  // false
+    case DATA_PROCESSOR_FIELD_FIXED:
+      return 12;  // -2147483.648
+    default:
+      return 0;
+  }
+}
+
+static bool valid_field(const DataProcessorField* spec, const char* field, size_t length) {
+  if (length > field_max_length(spec)) {
+    return false;
+  }
+  const char* pos = field;
+  const char* end = field + length;
+  switch (spec->type) {
+    case DATA_PROCESSOR_FIELD_BOOL:
+      return (length == 1 && (field[0] == '0' || field[0] == '1')) ||
+        (length == 4 && strncmp(field, "true", 4) == 0) ||
+        (length == 5 && strncmp(field, "false", 5) == 0);
+    case DATA_PROCESSOR_FIELD_INT:
+    case DATA_PROCESSOR_FIELD_FIXED: {
+      if (pos < end && (*pos == '-' || *pos == '+')) {
+        pos++;
+      }
+      size_t digits = 0;
+      bool point = false;
+      for (; pos < end; pos++) {
+        if (*pos >= '0' && *pos <= '9') {
+          digits += 1;
+        } else if (*pos == '.' && spec->type == DATA_PROCESSOR_FIELD_FIXED && !point) {
+          point = true;
+        } else {
+          return false;
+        }
+      }
+      if (digits == 0) {
+        return false;
+      }
+      uint8_t scale = spec->type == DATA_PROCESSOR_FIELD_FIXED ? spec->scale : 0;
+      int64_t value = dp_parse_scaled(field, length, scale);
+      if (value < INT32_MIN || value > INT32_MAX) {
+        return false;
+      }
+      return (0 == spec->min && 0 == spec->max) || (value >= spec->min && value <= spec->max);
+    }
+    default:
+      return true;
+  }
+}
@@ -0,0 +1,290 @@
+#include <pebble.h>
+#include "data-processor-internal.h"
+
+
+// Compressed streams refer back at most this many bytes. Part of the format,
+// so it must match WINDOW_SIZE in src/js/index.js.
+#define DATA_PROCESSOR_WINDOW_SIZE 1024
+#define WINDOW_MASK (DATA_PROCESSOR_WINDOW_SIZE - 1)
+#define MIN_MATCH 3
+
+struct DataProcessorStream {
+  char delim;
+  DataProcessorFieldHandler handler;
+  void* context;
+  uint16_t next_seq;
+  uint16_t field_index;
+  bool started;
+  bool complete;
+  DataProcessorStatus status;
+  // Holds the start of a field that continues into the next chunk.
+  char* carry;
+  uint16_t carry_len;
+  uint16_t carry_cap;
+  // Reused for every field handed to the handler.
+  ProcessingState field;
+  // Decompression state, only used by compressed streams. Output is written
+  // to the window and parsed each time it wraps and at the end of each chunk.
+  uint8_t* window;
+  uint16_t window_pos;
+  uint16_t flush_pos;
+  uint8_t flags;
+  uint8_t flag_bits;
+  bool have_match_byte;
+  uint8_t match_byte;
+};
+
+
+static void stream_emit(DataProcessorStream* stream, char* field, size_t length);
+static bool stream_consume(DataProcessorStream* stream, const uint8_t* data, size_t length, bool last);
+static bool stream_inflate(DataProcessorStream* stream, const uint8_t* data, size_t length, bool last);
+static bool window_put(DataProcessorStream* stream, uint8_t byte);
+static bool window_flush(DataProcessorStream* stream, bool last);
+static int32_t tuple_int(const Tuple* tuple);
+static void stream_ack(const DataProcessorStreamKeys* keys, int32_t seq, DataProcessorStatus status);
+
+
+DataProcessorStream* data_processor_stream_create(char delim, uint16_t max_field_length, DataProcessorFieldHandler handler, void* context) {
+  if (NULL == handler) {
+    return NULL;
+  }
+  DataProcessorStream* stream = malloc(sizeof(DataProcessorStream));
+  if (NULL == stream) {
+    return NULL;
+  }
+  stream->carry = malloc(max_field_length > 0 ? max_field_length : 1);
+  if (NULL == stream->carry) {
+    free(stream);
+    return NULL;
+  }
+  stream->carry_cap = max_field_length;
+  stream->window = NULL;
+  stream->delim = delim;
+  stream->handler = handler;
+  stream->context = context;
+  data_processor_stream_reset(stream);
+  return stream;
+}
+
+DataProcessorStream* data_processor_stream_create_compressed(char delim, uint16_t max_field_length, DataProcessorFieldHandler handler, void* context) {
+  DataProcessorStream* stream = data_processor_stream_create(delim, max_field_length, handler, context);
+  if (NULL == stream) {
+    return NULL;
+  }
+  stream->window = malloc(DATA_PROCESSOR_WINDOW_SIZE);
+  if (NULL == stream->window) {
+    data_processor_stream_destroy(stream);
+    return NULL;
+  }
+  return stream;
+}
+
+void data_processor_stream_destroy(DataProcessorStream* stream) {
+  if (NULL == stream) {
+    return;
+  }
+  free(stream->window);
+  free(stream->carry);
+  free(stream);
+}
+
+void data_processor_stream_reset(DataProcessorStream* stream) {
+  if (NULL == stream) {
+    return;
+  }
+  stream->next_seq = 0;
+  stream->field_index = 0;
+  stream->started = false;
+  stream->complete = false;
+  stream->status = DATA_PROCESSOR_OK;
+  stream->carry_len = 0;
+  stream->window_pos = 0;
+  stream->flush_pos = 0;
+  stream->flag_bits = 0;
+  stream->have_match_byte = false;
+}
+
+bool data_processor_stream_feed(DataProcessorStream* stream, uint16_t seq, const uint8_t* data, size_t length, bool last) {
+  if (NULL == stream || stream->status != DATA_PROCESSOR_OK) {
+    return false;
+  }
+  if (seq < stream->next_seq || stream->complete) {
+    // A resend of a chunk that has already been consumed.
+    return true;
+  }
+  if (seq > stream->next_seq) {
+    stream->status = DATA_PROCESSOR_ERROR_OUT_OF_ORDER;
+    return false;
+  }
+  bool consumed = (NULL != stream->window) ? stream_inflate(stream, data, length, last)
+                                           : stream_consume(stream, data, length, last);
+  if (!consumed) {
+    return false;
+  }
+  stream->next_seq += 1;
+  return true;
+}
+
+bool data_processor_stream_handle_message(DataProcessorStream* stream, const DictionaryIterator* iter, const DataProcessorStreamKeys* keys) {
+  if (NULL == stream || NULL == iter || NULL == keys) {
+    return false;
+  }
+  Tuple* seq = dict_find(iter, keys->seq);
+  Tuple* data = dict_find(iter, keys->data);
+  if (NULL == seq || NULL == data) {
+    return false;
+  }
+  size_t length = data->length;
+  if (data->type == TUPLE_CSTRING && length > 0) {
+    length -= 1;
+  }
+  bool last = NULL != dict_find(iter, keys->last);
+  bool consumed = data_processor_stream_feed(stream, tuple_int(seq), data->value->data, length, last);
+  stream_ack(keys, tuple_int(seq), stream->status);
+  return consumed;
+}
+
+bool data_processor_stream_is_complete(DataProcessorStream* stream) {
+  if (NULL == stream) {
+    return false;
+  }
+  return stream->complete;
+}
+
+DataProcessorStatus data_processor_stream_get_status(DataProcessorStream* stream) {
+  if (NULL == stream) {
+    return DATA_PROCESSOR_ERROR_NULL_STATE;
+  }
+  return stream->status;
+}
+
+static void stream_emit(DataProcessorStream* stream, char* field, size_t length) {
+  dp_init_field_state(&stream->field, field, length, stream->delim);
+  stream->handler(&stream->field, stream->field_index, stream->context);
+  stream->field_index += 1;
+}
+
+// Emits every field completed by this chunk, parsing in place where possible.
+// Only a field that spans chunks is copied, into the carry buffer.
+static bool stream_consume(DataProcessorStream* stream, const uint8_t* data, size_t length, bool last) {
+  char* pos = (char*)data;
+  char* end = pos + length;
+  stream->started = stream->started || length > 0;
+  char* delim;
+  while (pos < end && (delim = memchr(pos, stream->delim, end - pos)) != NULL) {
+    if (stream->carry_len > 0) {
+      size_t extra = delim - pos;
+      if (stream->carry_len + extra > stream->carry_cap) {
+        stream->status = DATA_PROCESSOR_ERROR_FIELD_TOO_LONG;
+        return false;
+      }
+      memcpy(stream->carry + stream->carry_len, pos, extra);
+      size_t carry_len = stream->carry_len + extra;
+      stream->carry_len = 0;
+      stream_emit(stream, stream->carry, carry_len);
+    } else {
+      stream_emit(stream, pos, delim - pos);
+    }
+    pos = delim + 1;
+  }
+  size_t rest = end - pos;
+  if (stream->carry_len + rest > stream->carry_cap) {
+    stream->status = DATA_PROCESSOR_ERROR_FIELD_TOO_LONG;
+    return false;
+  }
+  memcpy(stream->carry + stream->carry_len, pos, rest);
+  stream->carry_len += rest;
+  if (last) {
+    // Like data_processor_count, an empty payload has no fields.
+    if (stream->started) {
+      size_t carry_len = stream->carry_len;
+      stream->carry_len = 0;
+      stream_emit(stream, stream->carry, carry_len);
+    }
+    stream->complete = true;
+  }
+  return true;
+}
+
+// Decompresses a chunk into the window, one byte at a time so that groups and
+// matches may be split across chunks. See compress in src/js/index.js.
+static bool stream_inflate(DataProcessorStream* stream, const uint8_t* data, size_t length, bool last) {
+  for (size_t n = 0; n < length; n += 1) {
+    uint8_t byte = data[n];
+    if (stream->flag_bits == 0) {
+      stream->flags = byte;
+      stream->flag_bits = 8;
+      continue;
+    }
+    if (stream->flags & 1) {
+      if (!window_put(stream, byte)) {
+        return false;
+      }
+    } else if (!stream->have_match_byte) {
+      stream->match_byte = byte;
+      stream->have_match_byte = true;
+      continue;
+    } else {
+      uint16_t distance = ((stream->match_byte << 2) | (byte >> 6)) + 1;
+      uint8_t match_len = (byte & 0x3F) + MIN_MATCH;
+      stream->have_match_byte = false;
+      for (uint8_t m = 0; m < match_len; m += 1) {
+        if (!window_put(stream, stream->window[(stream->window_pos - distance) & WINDOW_MASK])) {
+          return false;
+        }
+      }
+    }
+    stream->flags >>= 1;
+    stream->flag_bits -= 1;
+  }
+  if (last && stream->have_match_byte) {
+    stream->status = DATA_PROCESSOR_ERROR_MALFORMED;
+    return false;
+  }
+  return window_flush(stream, last);
+}
+
+static bool window_put(DataProcessorStream* stream, uint8_t byte) {
+  stream->window[stream->window_pos] = byte;
+  stream->window_pos += 1;
+  if (stream->window_pos == DATA_PROCESSOR_WINDOW_SIZE) {
+    if (!window_flush(stream, false)) {
+      return false;
+    }
+    stream->window_pos = 0;
+    stream->flush_pos = 0;
+  }
+  return true;
+}
+
+// Parses the window output that has not been parsed yet.
+static bool window_flush(DataProcessorStream* stream, bool last) {
+  uint16_t start = stream->flush_pos;
+  stream->flush_pos = stream->window_pos;
+  return stream_consume(stream, stream->window + start, stream->window_pos - start, last);
+}
+
+// Replies to a chunk once it has been parsed (or rejected), since the system
+// acknowledges every message that reaches the inbox handler. The sender
+// resends the chunk if this reply is lost, for example when the outbox is busy.
+static void stream_ack(const DataProcessorStreamKeys* keys, int32_t seq, DataProcessorStatus status) {
+  DictionaryIterator* iter;
+  if (app_message_outbox_begin(&iter) != APP_MSG_OK) {
+    return;
+  }
+  dict_write_int32(iter, keys->seq, seq);
+  dict_write_uint8(iter, keys->status, status);
+  app_message_outbox_send();
+}
+
+// Reads a TUPLE_INT or TUPLE_UINT value of any width.
+static int32_t tuple_int(const Tuple* tuple) {
+  switch (tuple->length) {
+    case 1:
+      return tuple->type == TUPLE_INT ? tuple->value->int8 : tuple->value->uint8;
+    case 2:
+      return tuple->type == TUPLE_INT ? tuple->value->int16 : tuple->value->uint16;
+    default:
+      return tuple->value->int32;
+  }
+}
@@ -0,0 +1,116 @@
+#include <pebble.h>
+#include "data-processor-internal.h"
+
+
+typedef struct {
+  // The slot's own copy of its payload, which views decoded from it point into.
+  char* payload;
+  size_t capacity;
+  ProcessingState state;
+  void* values;
+  bool loaded;
+} SwapSlot;
+
+struct DataProcessorSwap {
+  SwapSlot slots[2];
+  uint8_t front;
+  bool pending;
+  size_t values_size;
+  DataProcessorDecodeHandler decode;
+  DataProcessorReleaseHandler release;
+  void* context;
+};
+
+
+static void swap_release(DataProcessorSwap* swap, SwapSlot* slot);
+
+
+DataProcessorSwap* data_processor_swap_create(size_t values_size, DataProcessorDecodeHandler decode, DataProcessorReleaseHandler release, void* context) {
+  if (NULL == decode || values_size == 0) {
+    return NULL;
+  }
+  DataProcessorSwap* swap = malloc(sizeof(DataProcessorSwap));
+  if (NULL == swap) {
+    return NULL;
+  }
+  memset(swap, 0, sizeof(DataProcessorSwap));
+  for (uint8_t n = 0; n < 2; n += 1) {
+    swap->slots[n].values = malloc(values_size);
+    if (NULL == swap->slots[n].values) {
+      data_processor_swap_destroy(swap);
+      return NULL;
+    }
+  }
+  swap->values_size = values_size;
+  swap->decode = decode;
+  swap->release = release;
+  swap->context = context;
+  return swap;
+}
+
+void data_processor_swap_destroy(DataProcessorSwap* swap) {
+  if (NULL == swap) {
+    return;
+  }
+  for (uint8_t n = 0; n < 2; n += 1) {
+    swap_release(swap, &swap->slots[n]);
+    free(swap->slots[n].values);
+    free(swap->slots[n].payload);
+  }
+  free(swap);
+}
+
+bool data_processor_swap_update(DataProcessorSwap* swap, const char* data, size_t length, char delim) {
+  if (NULL == swap || NULL == data) {
+    return false;
+  }
+  SwapSlot* back = &swap->slots[swap->front ^ 1];
+  // The back slot still holds the payload that was replaced by the last
+  // publish (or an unpublished update), which nothing can be reading any more.
+  swap_release(swap, back);
+  swap->pending = false;
+  if (back->capacity < length + 1) {
+    char* payload = realloc(back->payload, length + 1);
+    if (NULL == payload) {
+      return false;
+    }
+    back->payload = payload;
+    back->capacity = length + 1;
+  }
+  memcpy(back->payload, data, length);
+  back->payload[length] = '\0';
+  dp_init_state(&back->state, back->payload, length, delim);
+  memset(back->values, 0, swap->values_size);
+  back->loaded = true;
+  if (!swap->decode(&back->state, back->values, swap->context)) {
+    swap_release(swap, back);
+    return false;
+  }
+  swap->pending = true;
+  return true;
+}
+
+void data_processor_swap_publish(DataProcessorSwap* swap) {
+  if (NULL == swap || !swap->pending) {
+    return;
+  }
+  swap->front ^= 1;
+  swap->pending = false;
+}
+
+const void* data_processor_swap_front(DataProcessorSwap* swap) {
+  if (NULL == swap || !swap->slots[swap->front].loaded) {
+    return NULL;
+  }
+  return swap->slots[swap->front].values;
+}
+
+static void swap_release(DataProcessorSwap* swap, SwapSlot* slot) {
+  if (!slot->loaded) {
+    return;
+  }
+  if (NULL != swap->release) {
+    swap->release(slot->values, swap->context);
+  }
+  slot->loaded = false;
+}
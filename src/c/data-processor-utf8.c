@@ -0,0 +1,103 @@
+#include <pebble.h>
+#include "data-processor-internal.h"
+
+
+static bool valid_utf8(const uint8_t* pos, const uint8_t* end);
+
+
+bool data_processor_validate_utf8(ProcessingState* state) {
+  if (NULL == state) {
+    return false;
+  }
+  return valid_utf8((const uint8_t*)state->data_start, (const uint8_t*)state->data_end);
+}
+
+char* data_processor_get_string_truncated(ProcessingState* state, size_t max_chars) {
+  if (NULL == state) {
+    return NULL;
+  }
+  ProcessingCheckpoint checkpoint = data_processor_save(state);
+  size_t length;
+  char* field = dp_next_field(state, &length);
+  // No character is longer than four bytes, so this is enough room for the
+  // characters that are kept.
+  size_t cap = (max_chars < length / 4) ? max_chars * 4 : length;
+  char* tmp = dp_alloc_string(state, cap);
+  if (NULL == tmp) {
+    data_processor_restore(state, checkpoint);
+    return NULL;
+  }
+  // Copy and count in one pass, stopping at the lead byte of the first
+  // character past the limit.
+  size_t copy = 0;
+  size_t chars = 0;
+  for (; copy < cap; copy += 1) {
+    if (((uint8_t)field[copy] & 0xC0) != 0x80) {
+      if (chars == max_chars) {
+        break;
+      }
+      chars += 1;
+    }
+    tmp[copy] = field[copy];
+  }
+  tmp[copy] = '\0';
+  return tmp;
+}
+
+// Rejects overlong forms, surrogates and code points past U+10FFFF. Runs of
+// ASCII are skipped four bytes at a time.
+static bool valid_utf8(const uint8_t* pos, const uint8_t* end) {
+  while (pos < end) {
+    while (end - pos >= 4) {
+      uint32_t word;
+      memcpy(&word, pos, sizeof(word));
+      if (word & 0x80808080u) {
+        break;
+      }
+      pos += 4;
+    }
+    if (pos == end) {
+      break;
+    }
+    uint8_t lead = *pos;
+    if (lead < 0x80) {
+      pos++;
+      continue;
+    }
+    size_t extra;
+    uint8_t min = 0x80;
+    uint8_t max = 0xBF;
+    if (lead >= 0xC2 && lead <= 0xDF) {
+      extra = 1;
+    } else if (lead >= 0xE0 && lead <= 0xEF) {
+      extra = 2;
+      if (lead == 0xE0) {
+        min = 0xA0;
+      } else if (lead == 0xED) {
+        max = 0x9F;
+      }
+    } else if (lead >= 0xF0 && lead <= 0xF4) {
+      extra = 3;
+      if (lead == 0xF0) {
+        min = 0x90;
+      } else if (lead == 0xF4) {
+        max = 0x8F;
+      }
+    } else {
+      return false;
+    }
+    if ((size_t)(end - pos) <= extra) {
+      return false;
+    }
+    if (pos[1] < min || pos[1] > max) {
+      return false;
+    }
+    for (size_t n = 2; n <= extra; n += 1) {
+      if ((pos[n] & 0xC0) != 0x80) {
+        return false;
+      }
+    }
+    pos += extra + 1;
+  }
+  return true;
+}
@@ -1,27 +1,89 @@
 #include <pebble.h>
-#include "data-processor.h"
+#include "data-processor-internal.h"
 
 
-struct ProcessingState {
-  char* data_start;
-  char* data_pos;
-  char data_delim;
-};
-
+// Budgeted states refuse to copy strings once the heap would drop below this.
+#ifndef DATA_PROCESSOR_HEAP_RESERVE
+#define DATA_PROCESSOR_HEAP_RESERVE 2048
+#endif
 
 static ProcessingState* global = NULL;
 
 
+static inline bool in_delim_set(const uint32_t* set, char c);
+static char* field_end(const ProcessingState* state, char* pos);
+static int parse_int(const char* field, size_t length);
+
+
 void data_processor_init(char* data, char delim) {
   data_processor_deinit();
   global = data_processor_create(data, delim);
 }
 
 ProcessingState* data_processor_create(char* data, char delim) {
+  return data_processor_create_with_length(data, strlen(data), delim);
+}
+
+ProcessingState* data_processor_create_with_length(char* data, size_t length, char delim) {
   ProcessingState* state = malloc(sizeof(ProcessingState));
-  state->data_start = data;
-  state->data_pos = data;
-  state->data_delim = delim;
+  if (NULL == state) {
+    return NULL;
+  }
+  dp_init_state(state, data, length, delim);
+  return state;
+}
+
+ProcessingState* data_processor_create_with_delimiters(char* data, const char* delims) {
+  if (NULL == delims || '\0' == delims[0]) {
+    return NULL;
+  }
+  ProcessingState* state = data_processor_create(data, delims[0]);
+  if (NULL == state || '\0' == delims[1]) {
+    return state;
+  }
+  state->delim_set = calloc(8, sizeof(uint32_t));
+  if (NULL == state->delim_set) {
+    data_processor_destroy(state);
+    return NULL;
+  }
+  for (const char* delim = delims; *delim != '\0'; delim++) {
+    uint8_t c = *delim;
+    state->delim_set[c >> 5] |= (uint32_t)1 << (c & 31);
+  }
+  return state;
+}
+
+ProcessingState* data_processor_create_fixed_width(char* data, const uint8_t* widths, uint8_t num_widths) {
+  if (NULL == widths || num_widths == 0) {
+    return NULL;
+  }
+  uint16_t* offsets = malloc(sizeof(uint16_t) * (num_widths + 1));
+  if (NULL == offsets) {
+    return NULL;
+  }
+  offsets[0] = 0;
+  for (uint8_t n = 0; n < num_widths; n += 1) {
+    if (widths[n] == 0) {
+      free(offsets);
+      return NULL;
+    }
+    offsets[n + 1] = offsets[n] + widths[n];
+  }
+  ProcessingState* state = data_processor_create(data, '\0');
+  if (NULL == state) {
+    free(offsets);
+    return NULL;
+  }
+  state->field_offsets = offsets;
+  state->num_widths = num_widths;
+  return state;
+}
+
+ProcessingState* data_processor_create_length_prefixed(char* data) {
+  ProcessingState* state = data_processor_create(data, '\0');
+  if (NULL != state) {
+    state->length_prefixed = true;
+  }
   return state;
 }
 
@@ -29,6 +91,8 @@ void data_processor_destroy(ProcessingState* state) {
   if (NULL == state) {
     return;
   }
+  free(state->delim_set);
+  free(state->field_offsets);
   free(state);
 }
 
@@ -45,54 +109,456 @@ uint8_t data_processor_count(ProcessingState* state) {
   if (NULL == state) {
     return 0;
   }
-  if (strlen(state->data_start) == 0) {
+  if (state->data_start == state->data_end) {
     return 0;
   }
+  if (NULL != state->field_offsets) {
+    // Whole records, then the fields that start in the last partial record.
+    size_t length = state->data_end - state->data_start;
+    uint16_t record_width = state->field_offsets[state->num_widths];
+    size_t count = (length / record_width) * state->num_widths;
+    for (uint8_t n = 0; n < state->num_widths && state->field_offsets[n] < length % record_width; n += 1) {
+      count += 1;
+    }
+    return count;
+  }
+  if (state->length_prefixed) {
+    ProcessingState scan = *state;
+    data_processor_rewind(&scan);
+    uint8_t count = 0;
+    while (!scan.exhausted) {
+      size_t length;
+      dp_read_field(&scan, &length);
+      count += 1;
+    }
+    return count;
+  }
   char* pos = state->data_start;
   uint8_t count = 0;
-  while (*pos != '\0') {
-    if (*pos == state->data_delim) {
-      count += 1;
+  if (NULL != state->delim_set) {
+    while (pos < state->data_end) {
+      if (in_delim_set(state->delim_set, *pos)) {
+        count += 1;
+      }
+      pos++;
+    }
+  } else {
+    while (pos < state->data_end) {
+      if (*pos == state->data_delim) {
+        count += 1;
+      }
+      pos++;
     }
-    pos++;
   }
   return ++count;
 }
 
+bool data_processor_has_next(ProcessingState* state) {
+  if (NULL == state) {
+    return false;
+  }
+  if (state->projection == 0 || state->exhausted) {
+    return !state->exhausted;
+  }
+  // Look past fields the projection would skip, without moving the cursor.
+  ProcessingState scan = *state;
+  while (!scan.exhausted && !((scan.projection >> scan.record_field) & 1)) {
+    size_t length;
+    dp_read_field(&scan, &length);
+  }
+  return !scan.exhausted;
+}
+
+size_t data_processor_remaining_bytes(ProcessingState* state) {
+  if (NULL == state) {
+    return 0;
+  }
+  return state->data_end - state->data_pos;
+}
+
+ProcessingCheckpoint data_processor_save(ProcessingState* state) {
+  if (NULL == state) {
+    return (ProcessingCheckpoint) { .pos = NULL, .record_field = 0, .column = 0, .exhausted = true };
+  }
+  return (ProcessingCheckpoint) {
+    .pos = state->data_pos,
+    .record_field = state->record_field,
+    .column = state->column,
+    .exhausted = state->exhausted,
+  };
+}
+
+void data_processor_restore(ProcessingState* state, ProcessingCheckpoint checkpoint) {
+  if (NULL == state || NULL == checkpoint.pos) {
+    return;
+  }
+  if (checkpoint.pos < state->data_start || checkpoint.pos > state->data_end) {
+    return;
+  }
+  state->data_pos = checkpoint.pos;
+  state->record_field = checkpoint.record_field;
+  state->column = checkpoint.column;
+  state->exhausted = checkpoint.exhausted;
+}
+
+void data_processor_rewind(ProcessingState* state) {
+  if (NULL == state) {
+    return;
+  }
+  state->data_pos = state->data_start;
+  state->record_field = 0;
+  state->column = 0;
+  state->exhausted = (state->data_start == state->data_end);
+}
+
+void data_processor_set_heap_budget(ProcessingState* state, size_t budget) {
+  if (NULL == state) {
+    return;
+  }
+  state->heap_budget = budget;
+}
+
+size_t data_processor_get_heap_used(ProcessingState* state) {
+  if (NULL == state) {
+    return 0;
+  }
+  return state->heap_used;
+}
+
+void data_processor_free_string(ProcessingState* state, char* str) {
+  if (NULL == state || NULL == str) {
+    return;
+  }
+  // Pooled strings know their allocation size. Without a pool the string is a
+  // plain malloc block that callers may free themselves, so its length is used.
+  size_t size;
+  if (NULL != state->pool) {
+    size = state->pool_release(state->pool, str);
+  } else {
+    size = strlen(str) + 1;
+    free(str);
+  }
+  state->heap_used -= size < state->heap_used ? size : state->heap_used;
+}
+
+DataProcessorStatus data_processor_get_status(ProcessingState* state) {
+  if (NULL == state) {
+    return DATA_PROCESSOR_ERROR_NULL_STATE;
+  }
+  return state->status;
+}
+
+void data_processor_set_projection(ProcessingState* state, uint8_t fields_per_record, uint32_t mask) {
+  if (NULL == state) {
+    return;
+  }
+  if (fields_per_record == 0 || fields_per_record > 32 || mask == 0) {
+    state->projection = 0;
+    state->record_fields = 0;
+  } else {
+    state->projection = mask;
+    state->record_fields = fields_per_record;
+  }
+  state->record_field = 0;
+}
+
+bool data_processor_seek(ProcessingState* state, uint16_t field) {
+  if (NULL == state) {
+    return false;
+  }
+  if (NULL == state->field_offsets) {
+    data_processor_rewind(state);
+    data_processor_skip(state, field);
+    return !state->exhausted;
+  }
+  uint16_t record_width = state->field_offsets[state->num_widths];
+  size_t offset = (size_t)(field / state->num_widths) * record_width + state->field_offsets[field % state->num_widths];
+  size_t length = state->data_end - state->data_start;
+  if (offset >= length) {
+    state->data_pos = state->data_end;
+    state->exhausted = true;
+    return false;
+  }
+  state->data_pos = state->data_start + offset;
+  state->column = field % state->num_widths;
+  state->record_field = (state->record_fields > 0) ? field % state->record_fields : 0;
+  state->exhausted = false;
+  return true;
+}
+
+void data_processor_skip(ProcessingState* state, uint16_t count) {
+  if (NULL == state) {
+    return;
+  }
+  for (uint16_t n = 0; n < count && !state->exhausted; n += 1) {
+    size_t length;
+    dp_read_field(state, &length);
+  }
+}
+
 char* data_processor_get_string(ProcessingState* state) {
   if (NULL == state) {
     return NULL;
   }
-  char* data_block_start = state->data_pos;
-  int str_len = 0;
-  while (*state->data_pos != state->data_delim && *state->data_pos != '\0') {
-    state->data_pos++;
-    str_len += 1;
+  ProcessingCheckpoint checkpoint = data_processor_save(state);
+  size_t length;
+  char* field = dp_next_field(state, &length);
+  char* tmp = dp_alloc_string(state, length);
+  if (NULL == tmp) {
+    data_processor_restore(state, checkpoint);
+    return NULL;
   }
-  char* tmp = malloc(str_len + 1);
-  strncpy(tmp, data_block_start, str_len + 1);
-  tmp[str_len] = '\0';
-  state->data_pos++;
+  memcpy(tmp, field, length);
+  tmp[length] = '\0';
   return tmp;
-  return NULL;
+}
+
+DataProcessorView data_processor_get_view(ProcessingState* state) {
+  if (NULL == state) {
+    return (DataProcessorView) { .data = NULL, .length = 0 };
+  }
+  size_t length;
+  char* field = dp_next_field(state, &length);
+  return (DataProcessorView) { .data = field, .length = length };
+}
+
+size_t data_processor_get_string_into(ProcessingState* state, char* dst, size_t cap) {
+  if (NULL == state) {
+    if (NULL != dst && cap > 0) {
+      dst[0] = '\0';
+    }
+    return 0;
+  }
+  size_t length;
+  char* field = dp_next_field(state, &length);
+  if (NULL == dst || cap == 0) {
+    return length;
+  }
+  size_t copy = length;
+  if (copy >= cap) {
+    // Step back to the start of any UTF-8 sequence that would be cut in half.
+    copy = cap - 1;
+    while (copy > 0 && (field[copy] & 0xC0) == 0x80) {
+      copy--;
+    }
+  }
+  memcpy(dst, field, copy);
+  dst[copy] = '\0';
+  return length;
 }
 
 bool data_processor_get_bool(ProcessingState* state) {
   if (NULL == state) {
     return false;
   }
-  char bool_char =  *state->data_pos;
-  state->data_pos++;
-  state->data_pos++;
-  return (bool_char == '1');
+  size_t length;
+  char* field = dp_next_field(state, &length);
+  return dp_parse_bool(field, length);
 }
 
 int data_processor_get_int(ProcessingState* state) {
   if (NULL == state) {
     return -1;
   }
-  char* tmp_str = data_processor_get_string(state);
-  int num = atoi(tmp_str);
-  free(tmp_str);
-  return num;
+  size_t length;
+  char* field = dp_next_field(state, &length);
+  return parse_int(field, length);
+}
+
+void dp_init_state(ProcessingState* state, char* data, size_t length, char delim) {
+  state->data_start = data;
+  state->data_pos = data;
+  state->data_end = data + length;
+  state->data_delim = delim;
+  state->delim_set = NULL;
+  state->pool = NULL;
+  state->pool_alloc = NULL;
+  state->pool_release = NULL;
+  state->projection = 0;
+  state->record_fields = 0;
+  state->record_field = 0;
+  state->field_offsets = NULL;
+  state->num_widths = 0;
+  state->column = 0;
+  state->length_prefixed = false;
+  state->exhausted = (length == 0);
+  state->status = DATA_PROCESSOR_OK;
+  state->heap_budget = 0;
+  state->heap_used = 0;
+}
+
+static inline bool in_delim_set(const uint32_t* set, char c) {
+  uint8_t byte = c;
+  return (set[byte >> 5] >> (byte & 31)) & 1;
+}
+
+// Returns the delimiter (or end of data) that ends the field starting at pos.
+// For fixed-width states, returns the start of the next field instead.
+static char* field_end(const ProcessingState* state, char* pos) {
+  if (NULL != state->field_offsets) {
+    uint8_t n = (pos == state->data_pos) ? state->column : dp_column_at(state, pos);
+    uint16_t offset = (pos - state->data_start) % state->field_offsets[state->num_widths];
+    char* end = pos + (state->field_offsets[n + 1] - offset);
+    return end < state->data_end ? end : state->data_end;
+  }
+  if (NULL != state->delim_set) {
+    while (pos < state->data_end && !in_delim_set(state->delim_set, *pos)) {
+      pos++;
+    }
+  } else {
+    while (pos < state->data_end && *pos != state->data_delim) {
+      pos++;
+    }
+  }
+  return pos;
+}
+
+// Returns the content of the field at pos and stores its length. For
+// length-prefixed states this skips the prefix; a prefix with no colon makes
+// the rest of the data a single field.
+char* dp_field_at(const ProcessingState* state, char* pos, size_t* length) {
+  if (!state->length_prefixed) {
+    *length = field_end(state, pos) - pos;
+    return pos;
+  }
+  size_t limit = state->data_end - pos;
+  size_t prefix = 0;
+  while (pos < state->data_end && *pos >= '0' && *pos <= '9') {
+    if (prefix <= limit) {
+      prefix = prefix * 10 + (*pos - '0');
+    }
+    pos++;
+  }
+  if (pos < state->data_end && *pos == ':') {
+    pos++;
+  } else {
+    prefix = limit;
+  }
+  size_t available = state->data_end - pos;
+  *length = prefix < available ? prefix : available;
+  return pos;
+}
+
+// Find the bounds of the next field selected by the projection (if any) and
+// move the cursor past its delimiter.
+char* dp_next_field(ProcessingState* state, size_t* length) {
+  if (state->projection != 0) {
+    while (!state->exhausted && !((state->projection >> state->record_field) & 1)) {
+      size_t skipped;
+      dp_read_field(state, &skipped);
+    }
+  }
+  return dp_read_field(state, length);
+}
+
+// Finds the field of a fixed-width record that pos is in. Reads at the cursor
+// use the column kept in the state instead, so this is only needed for
+// positions found some other way, such as record index keys.
+uint8_t dp_column_at(const ProcessingState* state, const char* pos) {
+  uint16_t offset = (pos - state->data_start) % state->field_offsets[state->num_widths];
+  uint8_t n = 0;
+  while (n + 1 < state->num_widths && state->field_offsets[n + 1] <= offset) {
+    n += 1;
+  }
+  return n;
+}
+
+// Find the bounds of the field at the cursor and move the cursor past its
+// delimiter. The cursor is never moved past the end of the data. Reading the
+// field that ends at the end of the data marks the state as exhausted.
+char* dp_read_field(ProcessingState* state, size_t* length) {
+  char* field_start = dp_field_at(state, state->data_pos, length);
+  char* pos = field_start + *length;
+  if (NULL != state->field_offsets) {
+    state->data_pos = pos;
+    state->exhausted = (pos == state->data_end);
+    state->column += 1;
+    if (state->column == state->num_widths) {
+      state->column = 0;
+    }
+  } else if (state->length_prefixed) {
+    state->data_pos = pos;
+    state->exhausted = (pos == state->data_end);
+  } else if (pos < state->data_end) {
+    state->data_pos = pos + 1;
+  } else {
+    state->data_pos = pos;
+    state->exhausted = true;
+  }
+  if (state->record_fields > 0) {
+    state->record_field += 1;
+    if (state->record_field == state->record_fields) {
+      state->record_field = 0;
+    }
+  }
+  return field_start;
+}
+
+// Checks whether size more bytes fit in the state's heap budget (if any),
+// recording a failure in the state status.
+bool dp_budget_allows(ProcessingState* state, size_t size) {
+  if (state->heap_budget > 0) {
+    bool over_budget = state->heap_used + size > state->heap_budget;
+    if (over_budget || heap_bytes_free() < size + DATA_PROCESSOR_HEAP_RESERVE) {
+      state->status = DATA_PROCESSOR_ERROR_OUT_OF_BUDGET;
+      return false;
+    }
+  }
+  return true;
+}
+
+// Allocates a string of length characters plus the terminator, keeping within
+// the state's heap budget (if any). Failures are recorded in the state status.
+char* dp_alloc_string(ProcessingState* state, size_t length) {
+  size_t size = length + 1;
+  if (!dp_budget_allows(state, size)) {
+    return NULL;
+  }
+  char* str = (NULL != state->pool) ? state->pool_alloc(state->pool, size) : malloc(size);
+  if (NULL == str) {
+    state->status = DATA_PROCESSOR_ERROR_OUT_OF_MEMORY;
+    return NULL;
+  }
+  state->heap_used += size;
+  return str;
+}
+
+// Accepts "1" and "true" as true. Anything else, including "0" and "false",
+// is false.
+bool dp_parse_bool(const char* field, size_t length) {
+  switch (length) {
+    case 1:
+      return field[0] == '1';
+    case 4:
+      return strncmp(field, "true", 4) == 0;
+    default:
+      return false;
+  }
+}
+
+// Behaves like atoi on the field without needing it to be NUL terminated.
+static int parse_int(const char* field, size_t length) {
+  const char* pos = field;
+  const char* end = field + length;
+  while (pos < end && (*pos == ' ' || (*pos >= '\t' && *pos <= '\r'))) {
+    pos++;
+  }
+  bool negative = false;
+  if (pos < end && (*pos == '-' || *pos == '+')) {
+    negative = (*pos == '-');
+    pos++;
+  }
+  unsigned int value = 0;
+  while (pos < end && *pos >= '0' && *pos <= '9') {
+    value = value * 10 + (*pos - '0');
+    pos++;
+  }
+  return negative ? (int)(0 - value) : (int)value;
+}
+
+// Sets up a state holding just one field, as handed to field handlers. The
+// state always reports one element, even if it is empty.
+void dp_init_field_state(ProcessingState* field, char* data, size_t length, char delim) {
+  dp_init_state(field, data, length, delim);
+  field->exhausted = false;
 }
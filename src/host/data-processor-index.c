@@ -0,0 +1,169 @@
+// Host-only field index builder. Splits the payload into one range per core,
+// counts the delimiters in each range in parallel, then writes each range's
+// field offsets straight into its slot of the shared offset table.
+// Delimiters are single bytes, so any byte boundary is a safe split point.
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "data-processor-index.h"
+
+
+#define MIN_BYTES_PER_THREAD (64 * 1024)
+#define MAX_THREADS 64
+
+
+struct DataProcessorFieldIndex {
+  const char* data;
+  size_t count;
+  // count + 1 entries. Field n starts at offsets[n] and ends one byte before
+  // offsets[n + 1].
+  size_t* offsets;
+};
+
+typedef struct {
+  const char* data;
+  size_t begin;
+  size_t end;
+  char delim;
+  size_t count;
+  size_t* out;
+} IndexJob;
+
+
+static void* count_job(void* context);
+static void* fill_job(void* context);
+static void run_jobs(IndexJob* jobs, unsigned int num_jobs, void* (*fn)(void*));
+
+
+DataProcessorFieldIndex* data_processor_field_index_build(const char* data, size_t length, char delim, unsigned int threads) {
+  if (NULL == data) {
+    return NULL;
+  }
+  if (0 == threads) {
+    long cores = sysconf(_SC_NPROCESSORS_ONLN);
+    threads = cores > 0 ? (unsigned int)cores : 1;
+  }
+  size_t max_threads = length / MIN_BYTES_PER_THREAD + 1;
+  if (threads > max_threads) {
+    threads = (unsigned int)max_threads;
+  }
+  if (threads > MAX_THREADS) {
+    threads = MAX_THREADS;
+  }
+
+  DataProcessorFieldIndex* index = malloc(sizeof(DataProcessorFieldIndex));
+  if (NULL == index) {
+    return NULL;
+  }
+  index->data = data;
+  index->count = 0;
+  index->offsets = NULL;
+
+  IndexJob jobs[MAX_THREADS];
+  size_t chunk = length / threads;
+  for (unsigned int n = 0; n < threads; n += 1) {
+    jobs[n].data = data;
+    jobs[n].begin = n * chunk;
+    jobs[n].end = (n == threads - 1) ? length : (n + 1) * chunk;
+    jobs[n].delim = delim;
+    jobs[n].count = 0;
+    jobs[n].out = NULL;
+  }
+  run_jobs(jobs, threads, count_job);
+
+  size_t delims = 0;
+  for (unsigned int n = 0; n < threads; n += 1) {
+    delims += jobs[n].count;
+  }
+  // Matches data_processor_count: an empty payload has no fields.
+  index->count = (length == 0) ? 0 : delims + 1;
+  index->offsets = malloc(sizeof(size_t) * (index->count + 1));
+  if (NULL == index->offsets) {
+    free(index);
+    return NULL;
+  }
+  index->offsets[0] = 0;
+  index->offsets[index->count] = length + 1;
+  if (delims > 0) {
+    size_t base = 1;
+    for (unsigned int n = 0; n < threads; n += 1) {
+      jobs[n].out = index->offsets + base;
+      base += jobs[n].count;
+    }
+    run_jobs(jobs, threads, fill_job);
+  }
+  return index;
+}
+
+void data_processor_field_index_destroy(DataProcessorFieldIndex* index) {
+  if (NULL == index) {
+    return;
+  }
+  free(index->offsets);
+  free(index);
+}
+
+size_t data_processor_field_index_count(const DataProcessorFieldIndex* index) {
+  if (NULL == index) {
+    return 0;
+  }
+  return index->count;
+}
+
+const char* data_processor_field_index_get(const DataProcessorFieldIndex* index, size_t n, size_t* length) {
+  if (NULL == index || n >= index->count) {
+    return NULL;
+  }
+  if (NULL != length) {
+    *length = index->offsets[n + 1] - index->offsets[n] - 1;
+  }
+  return index->data + index->offsets[n];
+}
+
+static void* count_job(void* context) {
+  IndexJob* job = context;
+  const char* pos = job->data + job->begin;
+  const char* end = job->data + job->end;
+  size_t count = 0;
+  while (pos < end && (pos = memchr(pos, job->delim, end - pos)) != NULL) {
+    count += 1;
+    pos++;
+  }
+  job->count = count;
+  return NULL;
+}
+
+static void* fill_job(void* context) {
+  IndexJob* job = context;
+  const char* pos = job->data + job->begin;
+  const char* end = job->data + job->end;
+  size_t* out = job->out;
+  while (pos < end && (pos = memchr(pos, job->delim, end - pos)) != NULL) {
+    pos++;
+    *out++ = pos - job->data;
+  }
+  return NULL;
+}
+
+// Runs the first job on the calling thread and the rest on worker threads.
+// Falls back to running a job inline if a thread cannot be started.
+static void run_jobs(IndexJob* jobs, unsigned int num_jobs, void* (*fn)(void*)) {
+  pthread_t threads[MAX_THREADS];
+  bool started[MAX_THREADS];
+  for (unsigned int n = 1; n < num_jobs; n += 1) {
+    started[n] = pthread_create(&threads[n], NULL, fn, &jobs[n]) == 0;
+    if (!started[n]) {
+      fn(&jobs[n]);
+    }
+  }
+  fn(&jobs[0]);
+  for (unsigned int n = 1; n < num_jobs; n += 1) {
+    if (started[n]) {
+      pthread_join(threads[n], NULL);
+    }
+  }
+}
@@ -0,0 +1,15 @@
+#pragma once
+
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+
+typedef struct DataProcessorFieldIndex DataProcessorFieldIndex;
+
+
+DataProcessorFieldIndex* data_processor_field_index_build(const char* data, size_t length, char delim, unsigned int threads);
+void data_processor_field_index_destroy(DataProcessorFieldIndex* index);
+size_t data_processor_field_index_count(const DataProcessorFieldIndex* index);
+const char* data_processor_field_index_get(const DataProcessorFieldIndex* index, size_t n, size_t* length);
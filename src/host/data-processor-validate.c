@@ -0,0 +1,225 @@
+// Host command line tool that runs newline separated payloads through the
+// Data Processor library. Regular files are memory mapped and every record is
+// parsed in place; pipes and other streams are read in blocks instead.
+//
+// Usage: data-processor-validate [-d delim] [-n fields] [file]
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+#include "data-processor.h"
+
+
+#define READ_BLOCK_SIZE (256 * 1024)
+
+
+typedef struct {
+  char delim;
+  long expected_fields;
+  uint64_t records;
+  uint64_t bytes;
+  uint64_t fields;
+  uint64_t malformed;
+  uint64_t min_fields;
+  uint64_t max_fields;
+  uint64_t first_malformed;
+} Stats;
+
+
+static void process_record(Stats* stats, char* record, size_t length);
+static size_t process_lines(Stats* stats, char* data, size_t length, bool final);
+static int process_mapped(Stats* stats, int fd, size_t size);
+static int process_stream(Stats* stats, int fd);
+static double now_seconds(void);
+static void usage(const char* name);
+
+
+int main(int argc, char** argv) {
+  Stats stats = { .delim = '|', .expected_fields = -1, .min_fields = UINT64_MAX };
+  int opt;
+  while ((opt = getopt(argc, argv, "d:n:h")) != -1) {
+    switch (opt) {
+      case 'd':
+        stats.delim = optarg[0];
+        break;
+      case 'n':
+        stats.expected_fields = strtol(optarg, NULL, 10);
+        break;
+      default:
+        usage(argv[0]);
+        return 2;
+    }
+  }
+
+  int fd = STDIN_FILENO;
+  const char* name = "<stdin>";
+  if (optind < argc && strcmp(argv[optind], "-") != 0) {
+    name = argv[optind];
+    fd = open(name, O_RDONLY);
+    if (fd < 0) {
+      perror(name);
+      return 2;
+    }
+  }
+
+  double start = now_seconds();
+  struct stat st;
+  int result;
+  if (fstat(fd, &st) == 0 && S_ISREG(st.st_mode) && st.st_size > 0) {
+    result = process_mapped(&stats, fd, (size_t)st.st_size);
+  } else {
+    result = process_stream(&stats, fd);
+  }
+  double elapsed = now_seconds() - start;
+  if (fd != STDIN_FILENO) {
+    close(fd);
+  }
+  if (result != 0) {
+    perror(name);
+    return 2;
+  }
+
+  double mb = stats.bytes / (1024.0 * 1024.0);
+  printf("file:       %s\n", name);
+  printf("records:    %llu\n", (unsigned long long)stats.records);
+  printf("bytes:      %llu\n", (unsigned long long)stats.bytes);
+  printf("fields:     %llu", (unsigned long long)stats.fields);
+  if (stats.records > 0) {
+    printf(" (min %llu, max %llu, mean %.2f per record)",
+      (unsigned long long)stats.min_fields, (unsigned long long)stats.max_fields,
+      (double)stats.fields / stats.records);
+  }
+  printf("\n");
+  printf("malformed:  %llu", (unsigned long long)stats.malformed);
+  if (stats.malformed > 0) {
+    printf(" (first at record %llu)", (unsigned long long)stats.first_malformed);
+  }
+  printf("\n");
+  printf("time:       %.3f s\n", elapsed);
+  printf("throughput: %.1f MB/s\n", elapsed > 0 ? mb / elapsed : 0.0);
+  return stats.malformed > 0 ? 1 : 0;
+}
+
+// A record is malformed if it holds a NUL byte or, when an expected field
+// count was given, has a different number of fields.
+static void process_record(Stats* stats, char* record, size_t length) {
+  if (length > 0 && record[length - 1] == '\r') {
+    length -= 1;
+  }
+  if (length == 0) {
+    return;
+  }
+  stats->records += 1;
+  stats->bytes += length;
+
+  // Walk the fields rather than using data_processor_count, whose uint8_t
+  // result wraps past 255.
+  ProcessingState* state = data_processor_create_with_length(record, length, stats->delim);
+  uint64_t fields = 0;
+  while (data_processor_has_next(state)) {
+    data_processor_skip(state, 1);
+    fields += 1;
+  }
+  data_processor_destroy(state);
+
+  stats->fields += fields;
+  if (fields < stats->min_fields) {
+    stats->min_fields = fields;
+  }
+  if (fields > stats->max_fields) {
+    stats->max_fields = fields;
+  }
+  bool malformed = memchr(record, '\0', length) != NULL;
+  malformed = malformed || (stats->expected_fields >= 0 && fields != (uint64_t)stats->expected_fields);
+  if (malformed) {
+    if (stats->malformed == 0) {
+      stats->first_malformed = stats->records;
+    }
+    stats->malformed += 1;
+  }
+}
+
+// Processes every complete line and returns the number of bytes consumed.
+// When final is set, trailing bytes without a newline form the last record.
+static size_t process_lines(Stats* stats, char* data, size_t length, bool final) {
+  char* pos = data;
+  char* end = data + length;
+  char* newline;
+  while (pos < end && (newline = memchr(pos, '\n', end - pos)) != NULL) {
+    process_record(stats, pos, newline - pos);
+    pos = newline + 1;
+  }
+  if (final && pos < end) {
+    process_record(stats, pos, end - pos);
+    pos = end;
+  }
+  return pos - data;
+}
+
+static int process_mapped(Stats* stats, int fd, size_t size) {
+  char* data = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+  if (MAP_FAILED == data) {
+    return process_stream(stats, fd);
+  }
+  posix_madvise(data, size, POSIX_MADV_SEQUENTIAL);
+  process_lines(stats, data, size, true);
+  munmap(data, size);
+  return 0;
+}
+
+// Reads in blocks, carrying any partial line over to the start of the buffer.
+// The buffer grows only when a single line is longer than it.
+static int process_stream(Stats* stats, int fd) {
+  size_t capacity = READ_BLOCK_SIZE;
+  size_t used = 0;
+  char* buffer = malloc(capacity);
+  if (NULL == buffer) {
+    return -1;
+  }
+  for (;;) {
+    if (used == capacity) {
+      char* larger = realloc(buffer, capacity * 2);
+      if (NULL == larger) {
+        free(buffer);
+        return -1;
+      }
+      buffer = larger;
+      capacity *= 2;
+    }
+    ssize_t got = read(fd, buffer + used, capacity - used);
+    if (got < 0) {
+      free(buffer);
+      return -1;
+    }
+    if (got == 0) {
+      break;
+    }
+    used += got;
+    size_t consumed = process_lines(stats, buffer, used, false);
+    memmove(buffer, buffer + consumed, used - consumed);
+    used -= consumed;
+  }
+  process_lines(stats, buffer, used, true);
+  free(buffer);
+  return 0;
+}
+
+static double now_seconds(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static void usage(const char* name) {
+  fprintf(stderr, "Usage: %s [-d delim] [-n fields] [file]\n", name);
+  fprintf(stderr, "  -d delim   field delimiter (default '|')\n");
+  fprintf(stderr, "  -n fields  expected number of fields per record\n");
+  fprintf(stderr, "Reads standard input when no file (or '-') is given.\n");
+}
@@ -0,0 +1,317 @@
+/* global Pebble */
+
+// PebbleKit JS side of Data Processor.
+//
+// sendChunked splits a payload into numbered chunks and sends them one at a
+// time. The system acknowledges every message that reaches the watch, so
+// data_processor_stream_handle_message also replies with the chunk's sequence
+// number and the stream status once the chunk has been parsed. The next chunk
+// is only sent after that reply, so the watch never holds more than one chunk
+// of the payload at once, and a chunk the watch rejects stops the send.
+
+var DEFAULT_KEYS = {
+  seq: 'DataProcessorSeq',
+  data: 'DataProcessorData',
+  last: 'DataProcessorLast',
+  status: 'DataProcessorStatus'
+};
+
+var DEFAULT_CHUNK_SIZE = 256;
+var DEFAULT_RETRIES = 3;
+var DEFAULT_REPLY_TIMEOUT = 5000;
+
+// Names for DataProcessorStatus values, in the order of the C enum.
+var STATUS_NAMES = [
+  'OK',
+  'ERROR_NULL_STATE',
+  'ERROR_OUT_OF_BUDGET',
+  'ERROR_OUT_OF_MEMORY',
+  'ERROR_FIELD_TOO_LONG',
+  'ERROR_OUT_OF_ORDER',
+  'ERROR_MALFORMED'
+];
+
+// Must match DATA_PROCESSOR_WINDOW_SIZE in the C library.
+var WINDOW_SIZE = 1024;
+var MIN_MATCH = 3;
+var MAX_MATCH = 66;
+var HASH_SIZE = 4096;
+var MAX_CHAIN = 64;
+
+// Returns the UTF-8 bytes of a string as an array of numbers.
+function utf8Bytes(str) {
+  var encoded = unescape(encodeURIComponent(str));
+  var bytes = new Array(encoded.length);
+  for (var i = 0; i < encoded.length; i += 1) {
+    bytes[i] = encoded.charCodeAt(i);
+  }
+  return bytes;
+}
+
+// LZSS compression for data_processor_stream_create_compressed. Output is a
+// series of groups: a flag byte followed by up to eight items, one per flag
+// bit from the lowest up. A set bit is a literal byte. A clear bit is a two
+// byte match: a 10 bit distance minus one, then a 6 bit length minus three.
+function compress(payload) {
+  var input = typeof payload === 'string' ? utf8Bytes(payload) : payload;
+  var output = [];
+  var head = new Array(HASH_SIZE);
+  var prev = new Array(WINDOW_SIZE);
+  var flagPos = -1;
+  var flagBit = 8;
+
+  function hash(pos) {
+    return ((input[pos] << 8) ^ (input[pos + 1] << 4) ^ input[pos + 2]) & (HASH_SIZE - 1);
+  }
+
+  function insert(pos) {
+    if (pos + MIN_MATCH > input.length) {
+      return;
+    }
+    var h = hash(pos);
+    prev[pos % WINDOW_SIZE] = head[h];
+    head[h] = pos;
+  }
+
+  function startItem() {
+    if (flagBit === 8) {
+      flagPos = output.length;
+      output.push(0);
+      flagBit = 0;
+    }
+  }
+
+  var pos = 0;
+  while (pos < input.length) {
+    var bestLen = 0;
+    var bestDist = 0;
+    if (pos + MIN_MATCH <= input.length) {
+      var candidate = head[hash(pos)];
+      var chain = 0;
+      var maxLen = Math.min(MAX_MATCH, input.length - pos);
+      while (candidate !== undefined && pos - candidate <= WINDOW_SIZE && chain < MAX_CHAIN) {
+        var len = 0;
+        while (len < maxLen && input[candidate + len] === input[pos + len]) {
+          len += 1;
+        }
+        if (len > bestLen) {
+          bestLen = len;
+          bestDist = pos - candidate;
+          if (len === maxLen) {
+            break;
+          }
+        }
+        var next = prev[candidate % WINDOW_SIZE];
+        if (next === undefined || next >= candidate) {
+          break;
+        }
+        candidate = next;
+        chain += 1;
+      }
+    }
+    startItem();
+    if (bestLen >= MIN_MATCH) {
+      output.push(((bestDist - 1) >> 2) & 0xFF);
+      output.push((((bestDist - 1) & 0x03) << 6) | (bestLen - MIN_MATCH));
+      for (var i = 0; i < bestLen; i += 1) {
+        insert(pos + i);
+      }
+      pos += bestLen;
+    } else {
+      output[flagPos] |= 1 << flagBit;
+      output.push(input[pos]);
+      insert(pos);
+      pos += 1;
+    }
+    flagBit += 1;
+  }
+  return output;
+}
+
+// Encodes an array of values for data_processor_create_length_prefixed. Each
+// value is written as its length in UTF-8 bytes, a colon and then the value,
+// so values may contain any character. Booleans are written as 1 or 0.
+function encodeLengthPrefixed(values) {
+  var out = '';
+  for (var i = 0; i < values.length; i += 1) {
+    var value = values[i];
+    if (typeof value === 'boolean') {
+      value = value ? '1' : '0';
+    } else {
+      value = String(value);
+    }
+    out += utf8Bytes(value).length + ':' + value;
+  }
+  return out;
+}
+
+// Mirrors a DATA_PROCESSOR_RECORD field list from data-processor-record.h,
+// given as [type, name] pairs in the same order, such as
+// [['int', 'temp'], ['string', 'city'], ['bool', 'rain']]. encode(values, delim)
+// writes an object in the format the generated decoder reads, and throws if a
+// value contains the delimiter. decode(payload, delim) reads the format back.
+function defineRecord(fields) {
+  function encodeValue(type, value) {
+    switch (type) {
+      case 'int':
+        value = Number(value) || 0;
+        return String(value < 0 ? Math.ceil(value) : Math.floor(value));
+      case 'bool':
+        return value ? '1' : '0';
+      case 'string':
+      case 'view':
+        return value === undefined || value === null ? '' : String(value);
+      default:
+        throw new Error('Unknown field type ' + type);
+    }
+  }
+
+  function decodeValue(type, text) {
+    switch (type) {
+      case 'int':
+        return parseInt(text, 10) || 0;
+      case 'bool':
+        return text === '1' || text === 'true';
+      default:
+        return text;
+    }
+  }
+
+  return {
+    fields: fields,
+    encode: function (values, delim) {
+      delim = delim || '|';
+      return fields.map(function (field) {
+        var text = encodeValue(field[0], values[field[1]]);
+        if (text.indexOf(delim) !== -1) {
+          throw new Error('Field ' + field[1] + ' contains the delimiter');
+        }
+        return text;
+      }).join(delim);
+    },
+    decode: function (payload, delim) {
+      var parts = payload.split(delim || '|');
+      var values = {};
+      fields.forEach(function (field, n) {
+        values[field[1]] = decodeValue(field[0], n < parts.length ? parts[n] : '');
+      });
+      return values;
+    }
+  };
+}
+
+function chunkBytes(bytes, chunkSize) {
+  var chunks = [];
+  for (var start = 0; start < bytes.length; start += chunkSize) {
+    chunks.push(bytes.slice(start, start + chunkSize));
+  }
+  if (chunks.length === 0) {
+    chunks.push([]);
+  }
+  return chunks;
+}
+
+// Sends a payload (a string, or an array of byte values) in numbered chunks.
+// options.keys overrides the message keys, options.chunkSize the largest chunk
+// in bytes, options.retries the number of resends of a chunk that is refused
+// or not replied to, and options.replyTimeout how long to wait for the watch's
+// reply in milliseconds. Set options.compress when the watch uses a compressed
+// stream. callback(err) is called once the watch has parsed the last chunk, or
+// when sending fails; err.status is set when the watch rejected a chunk.
+function sendChunked(payload, options, callback) {
+  if (typeof options === 'function') {
+    callback = options;
+    options = {};
+  }
+  options = options || {};
+  callback = callback || function () {};
+  var keys = options.keys || DEFAULT_KEYS;
+  var chunkSize = options.chunkSize || DEFAULT_CHUNK_SIZE;
+  var retries = options.retries === undefined ? DEFAULT_RETRIES : options.retries;
+  var replyTimeout = options.replyTimeout || DEFAULT_REPLY_TIMEOUT;
+  var bytes = typeof payload === 'string' ? utf8Bytes(payload) : payload;
+  if (options.compress) {
+    bytes = compress(bytes);
+  }
+  var chunks = chunkBytes(bytes, chunkSize);
+  var current = 0;
+  var attempts = 0;
+  var timer = null;
+  var done = false;
+
+  function finish(err) {
+    if (done) {
+      return;
+    }
+    done = true;
+    clearTimeout(timer);
+    Pebble.removeEventListener('appmessage', onReply);
+    callback(err);
+  }
+
+  function retry(err) {
+    if (done) {
+      return;
+    }
+    if (attempts < retries) {
+      // The watch ignores chunks it has already consumed and replies again, so
+      // resending is safe.
+      attempts += 1;
+      send();
+    } else {
+      finish(err || new Error('Chunk ' + current + ' was not acknowledged'));
+    }
+  }
+
+  function send() {
+    var seq = current;
+    var attempt = attempts;
+    var message = {};
+    message[keys.seq] = seq;
+    message[keys.data] = chunks[seq];
+    if (seq === chunks.length - 1) {
+      message[keys.last] = 1;
+    }
+    clearTimeout(timer);
+    timer = setTimeout(function () {
+      retry(new Error('No reply for chunk ' + seq));
+    }, replyTimeout);
+    Pebble.sendAppMessage(message, null, function (err) {
+      if (seq === current && attempt === attempts) {
+        retry(err);
+      }
+    });
+  }
+
+  function onReply(e) {
+    var reply = e.payload || {};
+    if (reply[keys.status] === undefined || reply[keys.seq] !== current) {
+      return;
+    }
+    clearTimeout(timer);
+    var status = reply[keys.status];
+    if (status !== 0) {
+      var err = new Error('Chunk ' + current + ' rejected: ' + (STATUS_NAMES[status] || status));
+      err.status = status;
+      finish(err);
+    } else if (current === chunks.length - 1) {
+      finish(null);
+    } else {
+      current += 1;
+      attempts = 0;
+      send();
+    }
+  }
+
+  Pebble.addEventListener('appmessage', onReply);
+  send();
+}
+
+module.exports = {
+  DEFAULT_KEYS: DEFAULT_KEYS,
+  utf8Bytes: utf8Bytes,
+  compress: compress,
+  encodeLengthPrefixed: encodeLengthPrefixed,
+  defineRecord: defineRecord,
+  sendChunked: sendChunked
+};
@@ -1,5 +1,8 @@
 #include "unit.h"
 #include "data-processor.h"
+#include "data-processor-record.h"
+#include "data-processor-index.h"
+#include "pebble-stubs.h"
 
 #define VERSION_LABEL "2.1.1"
 
@@ -13,12 +16,21 @@
 #define KCYN  "\x1B[36m"
 #define KWHT  "\x1B[37m"
 
+#define WEATHER_FIELDS(FIELD) \
+  FIELD(int, temp) \
+  FIELD(string, city) \
+  FIELD(bool, rain) \
+  FIELD(view, summary)
+
+DATA_PROCESSOR_RECORD(Weather, weather, WEATHER_FIELDS)
+
 // Keep track of how many tests have run, and how many have passed.
 int tests_run = 0;
 int tests_passed = 0;
-const int NUM_TESTS = 16;
+const int NUM_TESTS = 75;
 
 static void before_each(void) {
+  stubs_reset();
 }
 
 static void after_each(void) {
@@ -180,6 +192,1026 @@ static char* test_count_null_state(void) {
   return 0;
 }
 
+// Booleans written as words should be extractable.
+static char* test_boolean_words(void) {
+  data_processor_init("true|false|1|0", '|');
+  ProcessingState* state = data_processor_get_global();
+  bool boolean1 = data_processor_get_bool(state);
+  bool boolean2 = data_processor_get_bool(state);
+  bool boolean3 = data_processor_get_bool(state);
+  bool boolean4 = data_processor_get_bool(state);
+  mu_assert(boolean1 && !boolean2 && boolean3 && !boolean4, "Word booleans not extracted correctly");
+  return 0;
+}
+
+// Reading a boolean should leave the cursor at the start of the next element.
+static char* test_boolean_keeps_position(void) {
+  data_processor_init("false|Hello", '|');
+  ProcessingState* state = data_processor_get_global();
+  data_processor_get_bool(state);
+  char* str = data_processor_get_string(state);
+  mu_assert(strcmp(str, "Hello") == 0, "Cursor out of place after reading boolean");
+  free(str);
+  return 0;
+}
+
+// Several booleans should be packable into a bitmask.
+static char* test_multiple_booleans_bitmask(void) {
+  data_processor_init("1|0|true|false|1|Hello", '|');
+  ProcessingState* state = data_processor_get_global();
+  uint32_t bits = data_processor_get_bools(state, 5);
+  char* str = data_processor_get_string(state);
+  mu_assert(0x15 == bits && strcmp(str, "Hello") == 0, "Booleans not packed into bitmask correctly");
+  free(str);
+  return 0;
+}
+
+// Decimal numbers should be extractable as scaled integers.
+static char* test_fixed_point(void) {
+  data_processor_init("-12.345|3.1|42|0.005", '|');
+  ProcessingState* state = data_processor_get_global();
+  int32_t num1 = data_processor_get_fixed(state, 3);
+  int32_t num2 = data_processor_get_fixed(state, 2);
+  int32_t num3 = data_processor_get_fixed(state, 1);
+  int32_t num4 = data_processor_get_fixed(state, 2);
+  mu_assert(-12345 == num1 && 310 == num2 && 420 == num3 && 1 == num4, "Fixed point numbers not extracted correctly");
+  return 0;
+}
+
+// Decimal numbers should be rounded half away from zero.
+static char* test_fixed_point_rounding(void) {
+  data_processor_init("-12.345|2.344", '|');
+  ProcessingState* state = data_processor_get_global();
+  int32_t num1 = data_processor_get_fixed(state, 2);
+  int32_t num2 = data_processor_get_fixed(state, 2);
+  mu_assert(-1235 == num1 && 234 == num2, "Fixed point numbers not rounded correctly");
+  return 0;
+}
+
+// Decimal numbers that do not fit should be clamped.
+static char* test_fixed_point_overflow(void) {
+  data_processor_init("99999999.9|-2147483.648|-99999999", '|');
+  ProcessingState* state = data_processor_get_global();
+  int32_t num1 = data_processor_get_fixed(state, 3);
+  int32_t num2 = data_processor_get_fixed(state, 3);
+  int32_t num3 = data_processor_get_fixed(state, 3);
+  mu_assert(INT32_MAX == num1 && INT32_MIN == num2 && INT32_MIN == num3, "Fixed point overflow not clamped");
+  return 0;
+}
+
+// Base64 elements should be decodable into a buffer.
+static char* test_base64_into(void) {
+  data_processor_init("SGVsbG8=|SGk|TWFu|8", '|');
+  ProcessingState* state = data_processor_get_global();
+  uint8_t buffer[8];
+  int len1 = data_processor_get_base64_into(state, buffer, sizeof(buffer));
+  bool pass = 5 == len1 && memcmp(buffer, "Hello", 5) == 0;
+  int len2 = data_processor_get_base64_into(state, buffer, sizeof(buffer));
+  pass = pass && 2 == len2 && memcmp(buffer, "Hi", 2) == 0;
+  int len3 = data_processor_get_base64_into(state, buffer, 2);
+  pass = pass && -1 == len3;
+  pass = pass && 8 == data_processor_get_int(state);
+  mu_assert(pass, "Base64 element not decoded correctly");
+  return 0;
+}
+
+// Hex elements should be decodable into a buffer.
+static char* test_hex_into(void) {
+  data_processor_init("00fFa5|0g|123", '|');
+  ProcessingState* state = data_processor_get_global();
+  uint8_t buffer[4];
+  int len1 = data_processor_get_hex_into(state, buffer, sizeof(buffer));
+  bool pass = 3 == len1 && 0x00 == buffer[0] && 0xFF == buffer[1] && 0xA5 == buffer[2];
+  pass = pass && -1 == data_processor_get_hex_into(state, buffer, sizeof(buffer));
+  pass = pass && -1 == data_processor_get_hex_into(state, buffer, sizeof(buffer));
+  mu_assert(pass, "Hex element not decoded correctly");
+  return 0;
+}
+
+// The field index should match the count and strings from a state object.
+static char* test_field_index_matches_getters(void) {
+  const size_t num_fields = 600;
+  const size_t field_len = 1500;
+  char* data = malloc(num_fields * (field_len + 1));
+  char* pos = data;
+  for (size_t n = 0; n < num_fields; n += 1) {
+    size_t len = (n * 7) % field_len;
+    memset(pos, 'a' + (n % 26), len);
+    pos += len;
+    *pos++ = '|';
+  }
+  *(pos - 1) = '\0';
+  size_t length = pos - 1 - data;
+  DataProcessorFieldIndex* index = data_processor_field_index_build(data, length, '|', 4);
+  ProcessingState* state = data_processor_create(data, '|');
+  bool pass = num_fields == data_processor_field_index_count(index);
+  size_t n = 0;
+  while (pass && data_processor_has_next(state)) {
+    size_t field_len;
+    const char* field = data_processor_field_index_get(index, n, &field_len);
+    char* str = data_processor_get_string(state);
+    pass = NULL != field && strlen(str) == field_len && strncmp(str, field, field_len) == 0;
+    free(str);
+    n += 1;
+  }
+  pass = pass && num_fields == n;
+  data_processor_destroy(state);
+  data_processor_field_index_destroy(index);
+  free(data);
+  mu_assert(pass, "Field index does not match getters");
+  return 0;
+}
+
+// The field index should count empty and trailing fields like a state object.
+static char* test_field_index_edges(void) {
+  DataProcessorFieldIndex* index1 = data_processor_field_index_build("", 0, '|', 2);
+  DataProcessorFieldIndex* index2 = data_processor_field_index_build("Hello|Goodbye||", 15, '|', 2);
+  size_t len;
+  const char* field = data_processor_field_index_get(index2, 3, &len);
+  bool pass = 0 == data_processor_field_index_count(index1);
+  pass = pass && 4 == data_processor_field_index_count(index2);
+  pass = pass && NULL != field && 0 == len;
+  pass = pass && NULL == data_processor_field_index_get(index2, 4, &len);
+  data_processor_field_index_destroy(index1);
+  data_processor_field_index_destroy(index2);
+  mu_assert(pass, "Field index does not handle empty fields");
+  return 0;
+}
+
+// A state object should only read the given number of bytes.
+static char* test_create_with_length(void) {
+  ProcessingState* state = data_processor_create_with_length("Hello|Hi\nHey|Yo", 8, '|');
+  bool pass = 2 == data_processor_count(state);
+  char* str1 = data_processor_get_string(state);
+  char* str2 = data_processor_get_string(state);
+  char* str3 = data_processor_get_string(state);
+  pass = pass && strcmp(str1, "Hello") == 0 && strcmp(str2, "Hi") == 0 && strcmp(str3, "") == 0;
+  free(str1);
+  free(str2);
+  free(str3);
+  data_processor_destroy(state);
+  mu_assert(pass, "Length bounded state read past its end");
+  return 0;
+}
+
+// A state object should know when all of its elements have been read.
+static char* test_has_next(void) {
+  data_processor_init("Hello|", '|');
+  ProcessingState* state = data_processor_get_global();
+  bool pass = data_processor_has_next(state);
+  data_processor_get_bool(state);
+  pass = pass && data_processor_has_next(state);
+  data_processor_get_bool(state);
+  pass = pass && !data_processor_has_next(state);
+  data_processor_get_bool(state);
+  pass = pass && !data_processor_has_next(state) && 0 == data_processor_remaining_bytes(state);
+  mu_assert(pass, "End of elements not detected correctly");
+  return 0;
+}
+
+// An empty state object should have no elements.
+static char* test_has_next_empty(void) {
+  data_processor_init("", '|');
+  mu_assert(!data_processor_has_next(data_processor_get_global()), "Empty state has elements");
+  return 0;
+}
+
+// The number of unread bytes should shrink as elements are read.
+static char* test_remaining_bytes(void) {
+  data_processor_init("12|345|6", '|');
+  ProcessingState* state = data_processor_get_global();
+  bool pass = 8 == data_processor_remaining_bytes(state);
+  data_processor_get_int(state);
+  pass = pass && 5 == data_processor_remaining_bytes(state);
+  data_processor_get_int(state);
+  data_processor_get_int(state);
+  pass = pass && 0 == data_processor_remaining_bytes(state);
+  mu_assert(pass, "Remaining bytes not tracked correctly");
+  return 0;
+}
+
+// Restoring a checkpoint should return the cursor to where it was saved.
+static char* test_checkpoint_restore(void) {
+  data_processor_init("1|2|3", '|');
+  ProcessingState* state = data_processor_get_global();
+  data_processor_get_int(state);
+  ProcessingCheckpoint checkpoint = data_processor_save(state);
+  int num1 = data_processor_get_int(state);
+  data_processor_get_int(state);
+  bool pass = !data_processor_has_next(state);
+  data_processor_restore(state, checkpoint);
+  pass = pass && data_processor_has_next(state);
+  int num2 = data_processor_get_int(state);
+  mu_assert(pass && 2 == num1 && 2 == num2, "Checkpoint not restored correctly");
+  return 0;
+}
+
+// Rewinding should return the cursor to the first element.
+static char* test_rewind(void) {
+  data_processor_init("Hello|1", '|');
+  ProcessingState* state = data_processor_get_global();
+  data_processor_get_bool(state);
+  data_processor_get_int(state);
+  data_processor_rewind(state);
+  char* str = data_processor_get_string(state);
+  mu_assert(strcmp(str, "Hello") == 0 && data_processor_has_next(state), "State not rewound correctly");
+  free(str);
+  return 0;
+}
+
+// Identical elements should share a single interned string.
+static char* test_interned_strings(void) {
+  DataProcessorInternTable* table = data_processor_intern_create(4);
+  ProcessingState* state1 = data_processor_create("Red|Blue|Red", '|');
+  ProcessingState* state2 = data_processor_create("Blue", '|');
+  const char* str1 = data_processor_get_string_interned(state1, table);
+  const char* str2 = data_processor_get_string_interned(state1, table);
+  const char* str3 = data_processor_get_string_interned(state1, table);
+  const char* str4 = data_processor_get_string_interned(state2, table);
+  bool pass = strcmp(str1, "Red") == 0 && strcmp(str2, "Blue") == 0;
+  pass = pass && str1 == str3 && str2 == str4;
+  data_processor_destroy(state1);
+  data_processor_destroy(state2);
+  data_processor_intern_destroy(table);
+  mu_assert(pass, "Identical elements not interned");
+  return 0;
+}
+
+// A full interning table should leave the element unread.
+static char* test_interned_strings_full(void) {
+  DataProcessorInternTable* table = data_processor_intern_create(1);
+  data_processor_init("Red|Blue|Red", '|');
+  ProcessingState* state = data_processor_get_global();
+  const char* str1 = data_processor_get_string_interned(state, table);
+  const char* str2 = data_processor_get_string_interned(state, table);
+  char* str3 = data_processor_get_string(state);
+  const char* str4 = data_processor_get_string_interned(state, table);
+  bool pass = NULL == str2 && strcmp(str3, "Blue") == 0 && str1 == str4;
+  free(str3);
+  data_processor_intern_destroy(table);
+  mu_assert(pass, "Full interning table did not leave element unread");
+  return 0;
+}
+
+// A string should be copyable into a buffer.
+static char* test_string_into(void) {
+  data_processor_init("Hello|Hi", '|');
+  ProcessingState* state = data_processor_get_global();
+  char buffer[8];
+  size_t len1 = data_processor_get_string_into(state, buffer, sizeof(buffer));
+  bool pass = 5 == len1 && strcmp(buffer, "Hello") == 0;
+  size_t len2 = data_processor_get_string_into(state, buffer, sizeof(buffer));
+  pass = pass && 2 == len2 && strcmp(buffer, "Hi") == 0;
+  mu_assert(pass, "String not copied into buffer");
+  return 0;
+}
+
+// A string too long for the buffer should be truncated on a character boundary.
+static char* test_string_into_truncated(void) {
+  data_processor_init("Hello World|Caf\xC3\xA9|1", '|');
+  ProcessingState* state = data_processor_get_global();
+  char buffer[5];
+  size_t len1 = data_processor_get_string_into(state, buffer, sizeof(buffer));
+  bool pass = 11 == len1 && strcmp(buffer, "Hell") == 0;
+  size_t len2 = data_processor_get_string_into(state, buffer, sizeof(buffer));
+  pass = pass && 5 == len2 && strcmp(buffer, "Caf") == 0;
+  pass = pass && 1 == data_processor_get_int(state);
+  mu_assert(pass, "String not truncated correctly");
+  return 0;
+}
+
+// A view should point at the next element without copying it.
+static char* test_view(void) {
+  char* data = "Hello|Hi";
+  data_processor_init(data, '|');
+  ProcessingState* state = data_processor_get_global();
+  DataProcessorView view1 = data_processor_get_view(state);
+  DataProcessorView view2 = data_processor_get_view(state);
+  bool pass = data == view1.data && 5 == view1.length;
+  pass = pass && data + 6 == view2.data && 2 == view2.length;
+  mu_assert(pass, "View does not point at element");
+  return 0;
+}
+
+// Strings should not be copied once the heap budget is used up.
+static char* test_heap_budget(void) {
+  data_processor_init("Hello|Goodbye|1", '|');
+  ProcessingState* state = data_processor_get_global();
+  data_processor_set_heap_budget(state, 10);
+  char* str1 = data_processor_get_string(state);
+  char* str2 = data_processor_get_string(state);
+  bool pass = strcmp(str1, "Hello") == 0 && NULL == str2;
+  pass = pass && DATA_PROCESSOR_ERROR_OUT_OF_BUDGET == data_processor_get_status(state);
+  pass = pass && 6 == data_processor_get_heap_used(state);
+  DataProcessorView view = data_processor_get_view(state);
+  pass = pass && 7 == view.length && strncmp(view.data, "Goodbye", 7) == 0;
+  pass = pass && 1 == data_processor_get_int(state);
+  free(str1);
+  mu_assert(pass, "Heap budget not respected");
+  return 0;
+}
+
+// Strings should not be copied when the heap is nearly full.
+static char* test_heap_budget_reserve(void) {
+  data_processor_init("Hello", '|');
+  ProcessingState* state = data_processor_get_global();
+  data_processor_set_heap_budget(state, 1024);
+  stub_heap_bytes_free = 1024;
+  char* str = data_processor_get_string(state);
+  bool pass = NULL == str && DATA_PROCESSOR_ERROR_OUT_OF_BUDGET == data_processor_get_status(state);
+  mu_assert(pass, "Heap reserve not respected");
+  return 0;
+}
+
+// A state object should read a dictionary string tuple in place.
+static char* test_create_from_dict(void) {
+  uint8_t buffer[64];
+  DictionaryIterator iter;
+  stub_dict_begin(&iter, buffer);
+  stub_dict_add_cstring(&iter, 7, "Hello|42|true");
+  ProcessingState* state = data_processor_create_from_dict(&iter, 7, '|');
+  char str[8];
+  data_processor_get_string_into(state, str, sizeof(str));
+  int num = data_processor_get_int(state);
+  bool boolean = data_processor_get_bool(state);
+  bool pass = strcmp(str, "Hello") == 0 && 42 == num && boolean && !data_processor_has_next(state);
+  pass = pass && NULL == data_processor_create_from_dict(&iter, 8, '|');
+  data_processor_destroy(state);
+  mu_assert(pass, "Dictionary tuple not read correctly");
+  return 0;
+}
+
+// The inbox size should fit the longest payload allowed by a schema.
+static char* test_inbox_size(void) {
+  const DataProcessorField fields[] = {
+    { .type = DATA_PROCESSOR_FIELD_STRING, .max_length = 32 },
+    { .type = DATA_PROCESSOR_FIELD_INT },
+    { .type = DATA_PROCESSOR_FIELD_BOOL },
+  };
+  const DataProcessorSchema schema = { .fields = fields, .num_fields = 3 };
+  // 1 + 7 + (32 + 11 + 5) + 2 delimiters + NUL
+  mu_assert(59 == data_processor_inbox_size(&schema), "Inbox size not calculated correctly");
+  return 0;
+}
+
+typedef struct {
+  char fields[8][16];
+  uint16_t count;
+} StreamResult;
+
+static void stream_collect(ProcessingState* field, uint16_t index, void* context) {
+  StreamResult* result = context;
+  if (index == result->count && index < 8) {
+    data_processor_get_string_into(field, result->fields[index], 16);
+  }
+  result->count += 1;
+}
+
+static bool stream_feed_str(DataProcessorStream* stream, uint16_t seq, const char* chunk, bool last) {
+  return data_processor_stream_feed(stream, seq, (const uint8_t*)chunk, strlen(chunk), last);
+}
+
+// Fields split across chunks should be reassembled in order.
+static char* test_stream_reassembly(void) {
+  StreamResult result = { .count = 0 };
+  DataProcessorStream* stream = data_processor_stream_create('|', 16, stream_collect, &result);
+  bool pass = stream_feed_str(stream, 0, "Hel", false);
+  pass = pass && 0 == result.count;
+  pass = pass && stream_feed_str(stream, 1, "lo|42|Go", false);
+  pass = pass && 2 == result.count;
+  pass = pass && stream_feed_str(stream, 2, "odbye|", false);
+  pass = pass && stream_feed_str(stream, 3, "1", true);
+  pass = pass && data_processor_stream_is_complete(stream) && 4 == result.count;
+  pass = pass && strcmp(result.fields[0], "Hello") == 0 && strcmp(result.fields[1], "42") == 0;
+  pass = pass && strcmp(result.fields[2], "Goodbye") == 0 && strcmp(result.fields[3], "1") == 0;
+  data_processor_stream_destroy(stream);
+  mu_assert(pass, "Stream not reassembled correctly");
+  return 0;
+}
+
+// Resent chunks should be acknowledged but not parsed again, and gaps refused.
+static char* test_stream_sequence(void) {
+  StreamResult result = { .count = 0 };
+  DataProcessorStream* stream = data_processor_stream_create('|', 16, stream_collect, &result);
+  bool pass = stream_feed_str(stream, 0, "a|b|", false);
+  pass = pass && stream_feed_str(stream, 0, "a|b|", false);
+  pass = pass && 2 == result.count;
+  pass = pass && !stream_feed_str(stream, 2, "c", true);
+  pass = pass && DATA_PROCESSOR_ERROR_OUT_OF_ORDER == data_processor_stream_get_status(stream);
+  data_processor_stream_reset(stream);
+  result.count = 0;
+  pass = pass && stream_feed_str(stream, 0, "", true) && 0 == result.count;
+  data_processor_stream_destroy(stream);
+  mu_assert(pass, "Stream sequence numbers not handled correctly");
+  return 0;
+}
+
+// A field longer than the carry buffer should stop the stream.
+static char* test_stream_field_too_long(void) {
+  StreamResult result = { .count = 0 };
+  DataProcessorStream* stream = data_processor_stream_create('|', 4, stream_collect, &result);
+  bool pass = stream_feed_str(stream, 0, "Hello World|Hi|Hel", false);
+  pass = pass && 2 == result.count;
+  pass = pass && !stream_feed_str(stream, 1, "lo|", false);
+  pass = pass && DATA_PROCESSOR_ERROR_FIELD_TOO_LONG == data_processor_stream_get_status(stream);
+  data_processor_stream_destroy(stream);
+  mu_assert(pass, "Stream field length not limited");
+  return 0;
+}
+
+// Chunks should be readable straight from AppMessage dictionaries.
+static char* test_stream_handle_message(void) {
+  const DataProcessorStreamKeys keys = { .seq = 1, .data = 2, .last = 3 };
+  StreamResult result = { .count = 0 };
+  DataProcessorStream* stream = data_processor_stream_create('|', 16, stream_collect, &result);
+  uint8_t buffer[64];
+  DictionaryIterator iter;
+  stub_dict_begin(&iter, buffer);
+  stub_dict_add_uint8(&iter, 1, 0);
+  stub_dict_add_cstring(&iter, 2, "Hello|Wor");
+  bool pass = data_processor_stream_handle_message(stream, &iter, &keys);
+  stub_dict_begin(&iter, buffer);
+  stub_dict_add_uint8(&iter, 1, 1);
+  stub_dict_add_cstring(&iter, 2, "ld");
+  stub_dict_add_uint8(&iter, 3, 1);
+  pass = pass && data_processor_stream_handle_message(stream, &iter, &keys);
+  pass = pass && data_processor_stream_is_complete(stream) && 2 == result.count;
+  pass = pass && strcmp(result.fields[1], "World") == 0 && 2 == stub_outbox_sent;
+  data_processor_stream_destroy(stream);
+  mu_assert(pass, "Stream messages not handled correctly");
+  return 0;
+}
+
+// Compressed chunks should be decompressed straight into the parser, even when
+// groups and matches are split across chunks.
+static char* test_stream_compressed(void) {
+  // compress('abcabcabc|Hello|Hello|Hello|1') from src/js/index.js
+  const uint8_t data[] = { 247, 97, 98, 99, 0, 131, 124, 72, 101, 108, 11, 108, 111, 1, 74, 49 };
+  StreamResult result = { .count = 0 };
+  DataProcessorStream* stream = data_processor_stream_create_compressed('|', 16, stream_collect, &result);
+  bool pass = data_processor_stream_feed(stream, 0, data, 5, false);
+  pass = pass && data_processor_stream_feed(stream, 1, data + 5, 7, false);
+  pass = pass && data_processor_stream_feed(stream, 2, data + 12, 4, true);
+  pass = pass && data_processor_stream_is_complete(stream) && 5 == result.count;
+  pass = pass && strcmp(result.fields[0], "abcabcabc") == 0 && strcmp(result.fields[1], "Hello") == 0;
+  pass = pass && strcmp(result.fields[3], "Hello") == 0 && strcmp(result.fields[4], "1") == 0;
+  data_processor_stream_destroy(stream);
+  mu_assert(pass, "Compressed stream not decompressed correctly");
+  return 0;
+}
+
+static void async_complete(ProcessingState* state, void* context) {
+  StreamResult* result = context;
+  result->count += 100;
+}
+
+static void async_slow_field(ProcessingState* field, uint16_t index, void* context) {
+  stream_collect(field, index, context);
+  stub_time_ms += 6;
+}
+
+// A time-sliced parse should hand every field over in steps, then complete.
+static char* test_parse_async(void) {
+  StreamResult result = { .count = 0 };
+  data_processor_init("a|b|c|d|e", '|');
+  DataProcessorJob* job = data_processor_parse_async(data_processor_get_global(), 2, 0, stream_collect, async_complete, &result);
+  bool pass = NULL != job && 0 == result.count;
+  int steps = stub_app_timer_run_all();
+  pass = pass && 3 == steps && 105 == result.count;
+  pass = pass && strcmp(result.fields[0], "a") == 0 && strcmp(result.fields[4], "e") == 0;
+  mu_assert(pass, "Time-sliced parse did not complete in steps");
+  return 0;
+}
+
+// A time-sliced parse should yield once its time budget is used up.
+static char* test_parse_async_time_budget(void) {
+  StreamResult result = { .count = 0 };
+  data_processor_init("a|b|c|d|e", '|');
+  data_processor_parse_async(data_processor_get_global(), 100, 10, async_slow_field, async_complete, &result);
+  int steps = stub_app_timer_run_all();
+  mu_assert(3 == steps && 105 == result.count, "Time-sliced parse did not respect time budget");
+  return 0;
+}
+
+// A cancelled time-sliced parse should not call its handlers.
+static char* test_parse_async_cancel(void) {
+  StreamResult result = { .count = 0 };
+  data_processor_init("a|b", '|');
+  DataProcessorJob* job = data_processor_parse_async(data_processor_get_global(), 1, 0, stream_collect, async_complete, &result);
+  data_processor_job_cancel(job);
+  int steps = stub_app_timer_run_all();
+  mu_assert(0 == steps && 0 == result.count, "Cancelled parse still ran");
+  return 0;
+}
+
+// A record declared with X-macros should decode its fields in order.
+static char* test_record_decode(void) {
+  data_processor_init("-4|London|1|Light rain", '|');
+  Weather weather;
+  weather_decode(data_processor_get_global(), &weather);
+  bool pass = -4 == weather.temp && strcmp(weather.city, "London") == 0 && weather.rain;
+  pass = pass && 10 == weather.summary.length && strncmp(weather.summary.data, "Light rain", 10) == 0;
+  weather_destroy(&weather);
+  mu_assert(pass && NULL == weather.city, "Record not decoded correctly");
+  return 0;
+}
+
+// A record declared with X-macros should encode to the same format it decodes.
+static char* test_record_encode(void) {
+  Weather weather = {
+    .temp = -2147483647 - 1,
+    .city = "Paris",
+    .rain = false,
+    .summary = { .data = "Sunny days", .length = 5 },
+  };
+  char buffer[64];
+  size_t len1 = weather_encode(&weather, buffer, sizeof(buffer), '|');
+  bool pass = strcmp(buffer, "-2147483648|Paris|0|Sunny") == 0 && strlen(buffer) == len1;
+  size_t len2 = weather_encode(&weather, buffer, 8, '|');
+  pass = pass && len1 == len2 && strcmp(buffer, "-214748") == 0;
+  weather.city = "A|B";
+  size_t len3 = weather_encode(&weather, buffer, sizeof(buffer), '|');
+  pass = pass && DATA_PROCESSOR_RECORD_INVALID == len3 && strcmp(buffer, "") == 0;
+  mu_assert(pass, "Record not encoded correctly");
+  return 0;
+}
+
+static const DataProcessorField validate_fields[] = {
+  { .type = DATA_PROCESSOR_FIELD_STRING, .max_length = 8 },
+  { .type = DATA_PROCESSOR_FIELD_INT, .min = -50, .max = 50 },
+  { .type = DATA_PROCESSOR_FIELD_BOOL },
+  { .type = DATA_PROCESSOR_FIELD_FIXED, .scale = 2 },
+};
+static const DataProcessorSchema validate_schema = { .fields = validate_fields, .num_fields = 4 };
+
+// A payload matching its schema should be valid, without moving the cursor.
+static char* test_validate(void) {
+  data_processor_init("London|-4|true|12.345", '|');
+  ProcessingState* state = data_processor_get_global();
+  int result = data_processor_validate(state, &validate_schema);
+  char* str = data_processor_get_string(state);
+  bool pass = -1 == result && strcmp(str, "London") == 0;
+  free(str);
+  mu_assert(pass, "Valid payload not accepted");
+  return 0;
+}
+
+// The first field that does not match the schema should be reported.
+static char* test_validate_failures(void) {
+  char* payloads[] = {
+    "Edinburgh|-4|true|1.5",
+    "London|51|true|1.5",
+    "London|4x|true|1.5",
+    "London|4|yes|1.5",
+    "London|4|1|1.2.3",
+    "London|4|1|99999999.99",
+    "London|4|1",
+    "London|4|1|1.5|",
+  };
+  int expected[] = { 0, 1, 1, 2, 3, 3, 3, 4 };
+  bool pass = true;
+  for (size_t n = 0; n < ARRAY_LENGTH(payloads); n += 1) {
+    ProcessingState* state = data_processor_create(payloads[n], '|');
+    pass = pass && expected[n] == data_processor_validate(state, &validate_schema);
+    data_processor_destroy(state);
+  }
+  mu_assert(pass, "Invalid payload not rejected at the right field");
+  return 0;
+}
+
+// Any delimiter in a set should end an element.
+static char* test_delimiter_set(void) {
+  ProcessingState* state = data_processor_create_with_delimiters("1,2;3|Hello World", ",;| ");
+  bool pass = 5 == data_processor_count(state);
+  int num1 = data_processor_get_int(state);
+  int num2 = data_processor_get_int(state);
+  int num3 = data_processor_get_int(state);
+  char* str = data_processor_get_string(state);
+  pass = pass && 1 == num1 && 2 == num2 && 3 == num3 && strcmp(str, "Hello") == 0;
+  free(str);
+  data_processor_destroy(state);
+  mu_assert(pass, "Delimiter set not applied");
+  return 0;
+}
+
+// Valid UTF-8 should be accepted and malformed sequences rejected.
+static char* test_validate_utf8(void) {
+  char* valid[] = { "", "Plain ASCII text|over several words", "Caf\xC3\xA9|\xE2\x82\xAC|\xF0\x9F\x98\x80" };
+  char* invalid[] = { "Caf\xC3", "\xC0\xAF", "\xED\xA0\x80", "\xF4\x90\x80\x80", "ABCDEFG\xFF" };
+  bool pass = true;
+  for (size_t n = 0; n < ARRAY_LENGTH(valid); n += 1) {
+    ProcessingState* state = data_processor_create(valid[n], '|');
+    pass = pass && data_processor_validate_utf8(state);
+    data_processor_destroy(state);
+  }
+  for (size_t n = 0; n < ARRAY_LENGTH(invalid); n += 1) {
+    ProcessingState* state = data_processor_create(invalid[n], '|');
+    pass = pass && !data_processor_validate_utf8(state);
+    data_processor_destroy(state);
+  }
+  mu_assert(pass, "UTF-8 not validated correctly");
+  return 0;
+}
+
+// Strings should be truncatable to a number of characters.
+static char* test_string_truncated(void) {
+  data_processor_init("Caf\xC3\xA9 au lait|Hi|\xE2\x82\xAC\xE2\x82\xAC", '|');
+  ProcessingState* state = data_processor_get_global();
+  char* str1 = data_processor_get_string_truncated(state, 4);
+  char* str2 = data_processor_get_string_truncated(state, 4);
+  char* str3 = data_processor_get_string_truncated(state, 1);
+  bool pass = strcmp(str1, "Caf\xC3\xA9") == 0 && strcmp(str2, "Hi") == 0 && strcmp(str3, "\xE2\x82\xAC") == 0;
+  free(str1);
+  free(str2);
+  free(str3);
+  mu_assert(pass, "String not truncated to characters");
+  return 0;
+}
+
+// Released pool blocks should be reused for strings of the same size class.
+static char* test_pool_reuse(void) {
+  DataProcessorPool* pool = data_processor_pool_create();
+  ProcessingState* state1 = data_processor_create("Hello|Goodbye", '|');
+  data_processor_set_pool(state1, pool);
+  char* str1 = data_processor_get_string(state1);
+  char* str2 = data_processor_get_string(state1);
+  data_processor_pool_release(pool, str1);
+  data_processor_pool_release(pool, str2);
+  ProcessingState* state2 = data_processor_create("Goodbye!|Hi", '|');
+  data_processor_set_pool(state2, pool);
+  char* str3 = data_processor_get_string(state2);
+  char* str4 = data_processor_get_string(state2);
+  bool pass = strcmp(str3, "Goodbye!") == 0 && strcmp(str4, "Hi") == 0;
+  pass = pass && str3 == str2 && str4 == str1;
+  data_processor_pool_release(pool, str3);
+  data_processor_pool_release(pool, str4);
+  data_processor_destroy(state1);
+  data_processor_destroy(state2);
+  data_processor_pool_destroy(pool);
+  mu_assert(pass, "Pool blocks not reused");
+  return 0;
+}
+
+// Strings too big for every size class should still come from a pool.
+static char* test_pool_oversize(void) {
+  char data[400];
+  memset(data, 'a', sizeof(data) - 1);
+  data[sizeof(data) - 1] = '\0';
+  DataProcessorPool* pool = data_processor_pool_create();
+  ProcessingState* state = data_processor_create(data, '|');
+  data_processor_set_pool(state, pool);
+  char* str = data_processor_get_string(state);
+  bool pass = strlen(str) == sizeof(data) - 1;
+  data_processor_pool_release(pool, str);
+  data_processor_destroy(state);
+  data_processor_pool_destroy(pool);
+  mu_assert(pass, "Oversize string not copied from pool");
+  return 0;
+}
+
+typedef struct {
+  int num;
+  char* str;
+} SwapValues;
+
+static bool swap_decode(ProcessingState* state, void* values, void* context) {
+  SwapValues* swap_values = values;
+  swap_values->num = data_processor_get_int(state);
+  swap_values->str = data_processor_get_string(state);
+  return data_processor_validate_utf8(state);
+}
+
+static void swap_release_values(void* values, void* context) {
+  SwapValues* swap_values = values;
+  free(swap_values->str);
+  *(int*)context += 1;
+}
+
+// Updates should only become visible once published, and old values should be
+// released on the update after they were replaced.
+static char* test_swap(void) {
+  int releases = 0;
+  DataProcessorSwap* swap = data_processor_swap_create(sizeof(SwapValues), swap_decode, swap_release_values, &releases);
+  bool pass = NULL == data_processor_swap_front(swap);
+  pass = pass && data_processor_swap_update(swap, "1|One", 5, '|');
+  pass = pass && NULL == data_processor_swap_front(swap);
+  data_processor_swap_publish(swap);
+  const SwapValues* front1 = data_processor_swap_front(swap);
+  pass = pass && NULL != front1 && 1 == front1->num && strcmp(front1->str, "One") == 0;
+  pass = pass && data_processor_swap_update(swap, "2|Two", 5, '|');
+  pass = pass && front1 == data_processor_swap_front(swap) && 0 == releases;
+  data_processor_swap_publish(swap);
+  const SwapValues* front2 = data_processor_swap_front(swap);
+  pass = pass && front1 != front2 && 2 == front2->num && strcmp(front1->str, "One") == 0;
+  pass = pass && data_processor_swap_update(swap, "3|Three", 7, '|');
+  pass = pass && 1 == releases;
+  pass = pass && !data_processor_swap_update(swap, "4|\xFF", 3, '|');
+  data_processor_swap_publish(swap);
+  pass = pass && front2 == data_processor_swap_front(swap) && 3 == releases;
+  data_processor_swap_destroy(swap);
+  pass = pass && 4 == releases;
+  mu_assert(pass, "Double buffer not swapped correctly");
+  return 0;
+}
+
+// Records should be found by binary search on their key field.
+static char* test_record_index(void) {
+  data_processor_init("3|Pear|5|Apple|9|Fig|1|Banana|4|Apricot", '|');
+  ProcessingState* state = data_processor_get_global();
+  DataProcessorRecordIndex* index = data_processor_record_index_create(state, 2, 1);
+  bool pass = 5 == data_processor_record_index_count(index);
+  int position = data_processor_record_index_find(index, "Fig");
+  pass = pass && 3 == position && -1 == data_processor_record_index_find(index, "Kiwi");
+  pass = pass && data_processor_record_index_seek(index, position);
+  pass = pass && 9 == data_processor_get_int(state);
+  DataProcessorView key = data_processor_record_index_key(index, 0);
+  pass = pass && 5 == key.length && strncmp(key.data, "Apple", 5) == 0;
+  data_processor_record_index_destroy(index);
+  mu_assert(pass, "Record not found in index");
+  return 0;
+}
+
+// Prefix searches should give the range of records starting with the prefix.
+static char* test_record_index_range(void) {
+  data_processor_init("Pear|Apple|Fig|Banana|Apricot|Ap", '|');
+  DataProcessorRecordIndex* index = data_processor_record_index_create(data_processor_get_global(), 1, 0);
+  uint16_t start = data_processor_record_index_lower_bound(index, "Ap", 2);
+  uint16_t end = data_processor_record_index_lower_bound(index, "Aq", 2);
+  DataProcessorView first = data_processor_record_index_key(index, start);
+  DataProcessorView last = data_processor_record_index_key(index, end - 1);
+  bool pass = 0 == start && 3 == end;
+  pass = pass && 2 == first.length && 7 == last.length && strncmp(last.data, "Apricot", 7) == 0;
+  data_processor_record_index_destroy(index);
+  mu_assert(pass, "Record index range not found");
+  return 0;
+}
+
+// Getters should only read the elements selected by a projection.
+static char* test_projection(void) {
+  data_processor_init("1|a|b|true|2|c|d|false", '|');
+  ProcessingState* state = data_processor_get_global();
+  data_processor_set_projection(state, 4, 0x9);
+  int num1 = data_processor_get_int(state);
+  bool boolean1 = data_processor_get_bool(state);
+  ProcessingCheckpoint checkpoint = data_processor_save(state);
+  int num2 = data_processor_get_int(state);
+  data_processor_restore(state, checkpoint);
+  int num3 = data_processor_get_int(state);
+  bool boolean2 = data_processor_get_bool(state);
+  bool pass = 1 == num1 && boolean1 && 2 == num2 && 2 == num3 && !boolean2;
+  pass = pass && !data_processor_has_next(state);
+  data_processor_init("1|a|b|x|2|c|d|y", '|');
+  state = data_processor_get_global();
+  data_processor_set_projection(state, 4, 0x1);
+  int sum = 0;
+  int count = 0;
+  while (data_processor_has_next(state)) {
+    sum += data_processor_get_int(state);
+    count += 1;
+  }
+  pass = pass && 2 == count && 3 == sum;
+  mu_assert(pass, "Projection not applied");
+  return 0;
+}
+
+// Skipped elements should not be read.
+static char* test_skip(void) {
+  data_processor_init("1|2|3|4", '|');
+  ProcessingState* state = data_processor_get_global();
+  data_processor_skip(state, 2);
+  int num1 = data_processor_get_int(state);
+  data_processor_skip(state, 5);
+  mu_assert(3 == num1 && !data_processor_has_next(state), "Elements not skipped");
+  return 0;
+}
+
+// Fixed-width elements should be readable with the normal getters.
+static char* test_fixed_width(void) {
+  const uint8_t widths[] = { 4, 3, 1 };
+  ProcessingState* state = data_processor_create_fixed_width("0930LHR10145JFK0", widths, 3);
+  bool pass = 6 == data_processor_count(state);
+  int num1 = data_processor_get_int(state);
+  char* str1 = data_processor_get_string(state);
+  bool boolean1 = data_processor_get_bool(state);
+  int num2 = data_processor_get_int(state);
+  char* str2 = data_processor_get_string(state);
+  bool boolean2 = data_processor_get_bool(state);
+  pass = pass && 930 == num1 && strcmp(str1, "LHR") == 0 && boolean1;
+  pass = pass && 145 == num2 && strcmp(str2, "JFK") == 0 && !boolean2;
+  pass = pass && !data_processor_has_next(state);
+  free(str1);
+  free(str2);
+  data_processor_destroy(state);
+  mu_assert(pass, "Fixed-width elements not extracted");
+  return 0;
+}
+
+// Any fixed-width element should be reachable by seeking.
+static char* test_fixed_width_seek(void) {
+  const uint8_t widths[] = { 4, 3, 1 };
+  ProcessingState* state = data_processor_create_fixed_width("0930LHR10145JFK0", widths, 3);
+  bool pass = data_processor_seek(state, 4);
+  char str[4];
+  data_processor_get_string_into(state, str, sizeof(str));
+  pass = pass && strcmp(str, "JFK") == 0;
+  pass = pass && data_processor_seek(state, 1);
+  data_processor_get_string_into(state, str, sizeof(str));
+  pass = pass && strcmp(str, "LHR") == 0;
+  pass = pass && !data_processor_seek(state, 6) && !data_processor_has_next(state);
+  data_processor_destroy(state);
+  mu_assert(pass, "Fixed-width elements not found by seeking");
+  return 0;
+}
+
+// Seeking delimited data should scan to the element.
+static char* test_seek_delimited(void) {
+  data_processor_init("1|2|3", '|');
+  ProcessingState* state = data_processor_get_global();
+  data_processor_get_int(state);
+  data_processor_get_int(state);
+  bool pass = data_processor_seek(state, 1) && 2 == data_processor_get_int(state);
+  pass = pass && !data_processor_seek(state, 3);
+  mu_assert(pass, "Delimited elements not found by seeking");
+  return 0;
+}
+
+// Length-prefixed elements may contain the characters used as delimiters.
+static char* test_length_prefixed(void) {
+  ProcessingState* state = data_processor_create_length_prefixed("5:Hello3:a|b2:424:true0:");
+  bool pass = 5 == data_processor_count(state);
+  char* str1 = data_processor_get_string(state);
+  char* str2 = data_processor_get_string(state);
+  int num = data_processor_get_int(state);
+  bool boolean = data_processor_get_bool(state);
+  char* str3 = data_processor_get_string(state);
+  pass = pass && strcmp(str1, "Hello") == 0 && strcmp(str2, "a|b") == 0;
+  pass = pass && 42 == num && boolean && strcmp(str3, "") == 0;
+  pass = pass && !data_processor_has_next(state);
+  free(str1);
+  free(str2);
+  free(str3);
+  data_processor_destroy(state);
+  mu_assert(pass, "Length-prefixed elements not extracted");
+  return 0;
+}
+
+// A length beyond the end of the data should stop at the end of the data.
+static char* test_length_prefixed_truncated(void) {
+  ProcessingState* state = data_processor_create_length_prefixed("2:ab9:cd");
+  data_processor_skip(state, 1);
+  DataProcessorView view = data_processor_get_view(state);
+  bool pass = 2 == view.length && strncmp(view.data, "cd", 2) == 0;
+  pass = pass && !data_processor_has_next(state);
+  data_processor_destroy(state);
+  mu_assert(pass, "Truncated length-prefixed element not bounded");
+  return 0;
+}
+
+static DataProcessorJob* self_cancel_job = NULL;
+
+static void async_cancel_field(ProcessingState* field, uint16_t index, void* context) {
+  stream_collect(field, index, context);
+  data_processor_job_cancel(self_cancel_job);
+}
+
+// A time-sliced parse cancelled by its own handler should stop straight away.
+static char* test_parse_async_cancel_from_handler(void) {
+  StreamResult result = { .count = 0 };
+  data_processor_init("a|b|c", '|');
+  self_cancel_job = data_processor_parse_async(data_processor_get_global(), 5, 0, async_cancel_field, async_complete, &result);
+  int steps = stub_app_timer_run_all();
+  mu_assert(1 == steps && 1 == result.count, "Parse cancelled by its handler still ran");
+  return 0;
+}
+
+// A rejected chunk should be reported back to the sender with its status.
+static char* test_stream_ack_status(void) {
+  const DataProcessorStreamKeys keys = { .seq = 1, .data = 2, .last = 3, .status = 4 };
+  StreamResult result = { .count = 0 };
+  DataProcessorStream* stream = data_processor_stream_create('|', 16, stream_collect, &result);
+  uint8_t buffer[64];
+  DictionaryIterator iter;
+  stub_dict_begin(&iter, buffer);
+  stub_dict_add_uint8(&iter, 1, 0);
+  stub_dict_add_cstring(&iter, 2, "Hello|");
+  bool pass = data_processor_stream_handle_message(stream, &iter, &keys);
+  Tuple* status = dict_find(&stub_outbox, 4);
+  pass = pass && 1 == stub_outbox_sent && NULL != status && DATA_PROCESSOR_OK == status->value->uint8;
+  stub_dict_begin(&iter, buffer);
+  stub_dict_add_uint8(&iter, 1, 2);
+  stub_dict_add_cstring(&iter, 2, "World");
+  pass = pass && !data_processor_stream_handle_message(stream, &iter, &keys);
+  Tuple* seq = dict_find(&stub_outbox, 1);
+  status = dict_find(&stub_outbox, 4);
+  pass = pass && 2 == stub_outbox_sent && NULL != seq && 2 == seq->value->int32;
+  pass = pass && NULL != status && DATA_PROCESSOR_ERROR_OUT_OF_ORDER == status->value->uint8;
+  data_processor_stream_destroy(stream);
+  mu_assert(pass, "Stream status not reported");
+  return 0;
+}
+
+// Freed strings should give their bytes back to the heap budget.
+static char* test_heap_budget_free(void) {
+  data_processor_init("Hello|World", '|');
+  ProcessingState* state = data_processor_get_global();
+  data_processor_set_heap_budget(state, 8);
+  bool pass = true;
+  for (int pass_num = 0; pass_num < 3; pass_num += 1) {
+    data_processor_rewind(state);
+    char* str1 = data_processor_get_string(state);
+    pass = pass && NULL != str1 && strcmp(str1, "Hello") == 0;
+    data_processor_free_string(state, str1);
+    char* str2 = data_processor_get_string(state);
+    pass = pass && NULL != str2 && strcmp(str2, "World") == 0;
+    data_processor_free_string(state, str2);
+  }
+  pass = pass && 0 == data_processor_get_heap_used(state);
+  pass = pass && DATA_PROCESSOR_OK == data_processor_get_status(state);
+  mu_assert(pass, "Freed strings not credited to the heap budget");
+  return 0;
+}
+
+// Interned strings should count against the heap budget.
+static char* test_heap_budget_interned(void) {
+  DataProcessorInternTable* table = data_processor_intern_create(4);
+  data_processor_init("Hello|Goodbye", '|');
+  ProcessingState* state = data_processor_get_global();
+  data_processor_set_heap_budget(state, 10);
+  const char* str1 = data_processor_get_string_interned(state, table);
+  const char* str2 = data_processor_get_string_interned(state, table);
+  bool pass = NULL != str1 && NULL == str2 && 6 == data_processor_get_heap_used(state);
+  pass = pass && DATA_PROCESSOR_ERROR_OUT_OF_BUDGET == data_processor_get_status(state);
+  pass = pass && 7 == data_processor_get_view(state).length;
+  data_processor_intern_destroy(table);
+  mu_assert(pass, "Interned strings not counted against the heap budget");
+  return 0;
+}
+
+// Fixed-width reads should stay on the right field after restoring or seeking
+// through a record index.
+static char* test_fixed_width_resume(void) {
+  const uint8_t widths[] = { 3, 2 };
+  ProcessingState* state = data_processor_create_fixed_width("LHR10JFK20CDG30", widths, 2);
+  data_processor_skip(state, 1);
+  ProcessingCheckpoint checkpoint = data_processor_save(state);
+  data_processor_skip(state, 2);
+  data_processor_restore(state, checkpoint);
+  bool pass = 10 == data_processor_get_int(state);
+  DataProcessorRecordIndex* index = data_processor_record_index_create(state, 2, 0);
+  int position = data_processor_record_index_find(index, "JFK");
+  pass = pass && 1 == position && data_processor_record_index_seek(index, position);
+  char str[4];
+  data_processor_get_string_into(state, str, sizeof(str));
+  pass = pass && strcmp(str, "JFK") == 0 && 20 == data_processor_get_int(state);
+  data_processor_record_index_destroy(index);
+  data_processor_destroy(state);
+  mu_assert(pass, "Fixed-width field lost after restore or seek");
+  return 0;
+}
+
+// A range with equal bounds should only accept that value.
+static char* test_validate_exact_range(void) {
+  static const DataProcessorField fields[] = {
+    { .type = DATA_PROCESSOR_FIELD_INT, .min = 1, .max = 1 },
+    { .type = DATA_PROCESSOR_FIELD_INT, .min = 1, .max = 1 },
+    { .type = DATA_PROCESSOR_FIELD_INT, .min = 5, .max = 5 },
+  };
+  static const DataProcessorSchema schema = { .fields = fields, .num_fields = 3 };
+  ProcessingState* state = data_processor_create("1|1|5", '|');
+  bool pass = -1 == data_processor_validate(state, &schema);
+  data_processor_destroy(state);
+  state = data_processor_create("1|1|6", '|');
+  pass = pass && 2 == data_processor_validate(state, &schema);
+  data_processor_destroy(state);
+  mu_assert(pass, "Exact range not enforced");
+  return 0;
+}
+
+// Pooled strings should give back the size they were allocated with, even
+// after being shortened.
+static char* test_heap_budget_free_pooled(void) {
+  // The second string is too big for every pool class.
+  char data[320] = "Hello|";
+  memset(data + 6, 'x', 300);
+  data[306] = '\0';
+  DataProcessorPool* pool = data_processor_pool_create();
+  ProcessingState* state = data_processor_create(data, '|');
+  data_processor_set_pool(state, pool);
+  data_processor_set_heap_budget(state, 512);
+  char* str1 = data_processor_get_string(state);
+  char* str2 = data_processor_get_string(state);
+  bool pass = NULL != str1 && NULL != str2 && 307 == data_processor_get_heap_used(state);
+  str1[1] = '\0';
+  str2[0] = '\0';
+  data_processor_free_string(state, str1);
+  data_processor_free_string(state, str2);
+  pass = pass && 0 == data_processor_get_heap_used(state);
+  data_processor_destroy(state);
+  data_processor_pool_destroy(pool);
+  mu_assert(pass, "Pooled strings not credited with their allocation size");
+  return 0;
+}
+
 static char* all_tests() {
   mu_run_test(test_init);
   mu_run_test(test_noinit);
@@ -197,6 +1229,65 @@ static char* all_tests() {
   mu_run_test(test_count_multiple);
   mu_run_test(test_count_none);
   mu_run_test(test_count_null_state);
+  mu_run_test(test_boolean_words);
+  mu_run_test(test_boolean_keeps_position);
+  mu_run_test(test_multiple_booleans_bitmask);
+  mu_run_test(test_fixed_point);
+  mu_run_test(test_fixed_point_rounding);
+  mu_run_test(test_fixed_point_overflow);
+  mu_run_test(test_base64_into);
+  mu_run_test(test_hex_into);
+  mu_run_test(test_field_index_matches_getters);
+  mu_run_test(test_field_index_edges);
+  mu_run_test(test_create_with_length);
+  mu_run_test(test_has_next);
+  mu_run_test(test_has_next_empty);
+  mu_run_test(test_remaining_bytes);
+  mu_run_test(test_checkpoint_restore);
+  mu_run_test(test_rewind);
+  mu_run_test(test_interned_strings);
+  mu_run_test(test_interned_strings_full);
+  mu_run_test(test_string_into);
+  mu_run_test(test_string_into_truncated);
+  mu_run_test(test_view);
+  mu_run_test(test_heap_budget);
+  mu_run_test(test_heap_budget_reserve);
+  mu_run_test(test_create_from_dict);
+  mu_run_test(test_inbox_size);
+  mu_run_test(test_stream_reassembly);
+  mu_run_test(test_stream_sequence);
+  mu_run_test(test_stream_field_too_long);
+  mu_run_test(test_stream_handle_message);
+  mu_run_test(test_stream_compressed);
+  mu_run_test(test_parse_async);
+  mu_run_test(test_parse_async_time_budget);
+  mu_run_test(test_parse_async_cancel);
+  mu_run_test(test_record_decode);
+  mu_run_test(test_record_encode);
+  mu_run_test(test_validate);
+  mu_run_test(test_validate_failures);
+  mu_run_test(test_delimiter_set);
+  mu_run_test(test_validate_utf8);
+  mu_run_test(test_string_truncated);
+  mu_run_test(test_pool_reuse);
+  mu_run_test(test_pool_oversize);
+  mu_run_test(test_swap);
+  mu_run_test(test_record_index);
+  mu_run_test(test_record_index_range);
+  mu_run_test(test_projection);
+  mu_run_test(test_skip);
+  mu_run_test(test_fixed_width);
+  mu_run_test(test_fixed_width_seek);
+  mu_run_test(test_seek_delimited);
+  mu_run_test(test_length_prefixed);
+  mu_run_test(test_length_prefixed_truncated);
+  mu_run_test(test_parse_async_cancel_from_handler);
+  mu_run_test(test_stream_ack_status);
+  mu_run_test(test_heap_budget_free);
+  mu_run_test(test_heap_budget_interned);
+  mu_run_test(test_fixed_width_resume);
+  mu_run_test(test_validate_exact_range);
+  mu_run_test(test_heap_budget_free_pooled);
   return 0;
 }
 
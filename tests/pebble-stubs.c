@@ -0,0 +1,155 @@
+#include "pebble-stubs.h"
+#include <stdarg.h>
+
+// Minimal implementations of the Pebble SDK functions used by the library, so
+// the tests can link on the host.
+
+#define MAX_TIMERS 8
+
+size_t stub_heap_bytes_free = 0;
+uint32_t stub_time_ms = 0;
+
+struct AppTimer {
+  AppTimerCallback callback;
+  void* data;
+  bool active;
+};
+
+static AppTimer timers[MAX_TIMERS];
+
+DictionaryIterator stub_outbox;
+int stub_outbox_sent = 0;
+static uint8_t outbox_buffer[64];
+
+struct __attribute__((__packed__)) Dictionary {
+  uint8_t count;
+  Tuple head[];
+};
+
+void stubs_reset(void) {
+  stub_heap_bytes_free = 24 * 1024;
+  stub_time_ms = 0;
+  memset(timers, 0, sizeof(timers));
+  stub_dict_begin(&stub_outbox, outbox_buffer);
+  stub_outbox_sent = 0;
+}
+
+int stub_app_timer_run_all(void) {
+  int fired = 0;
+  bool any = true;
+  while (any) {
+    any = false;
+    for (int n = 0; n < MAX_TIMERS; n += 1) {
+      if (timers[n].active) {
+        timers[n].active = false;
+        timers[n].callback(timers[n].data);
+        fired += 1;
+        any = true;
+      }
+    }
+  }
+  return fired;
+}
+
+AppTimer* app_timer_register(uint32_t timeout_ms, AppTimerCallback callback, void* callback_data) {
+  for (int n = 0; n < MAX_TIMERS; n += 1) {
+    if (!timers[n].active) {
+      timers[n] = (AppTimer) { .callback = callback, .data = callback_data, .active = true };
+      return &timers[n];
+    }
+  }
+  return NULL;
+}
+
+void app_timer_cancel(AppTimer* timer_handle) {
+  if (NULL != timer_handle) {
+    timer_handle->active = false;
+  }
+}
+
+uint16_t time_ms(time_t* tloc, uint16_t* out_ms) {
+  if (NULL != tloc) {
+    *tloc = stub_time_ms / 1000;
+  }
+  if (NULL != out_ms) {
+    *out_ms = stub_time_ms % 1000;
+  }
+  return stub_time_ms % 1000;
+}
+
+size_t heap_bytes_free(void) {
+  return stub_heap_bytes_free;
+}
+
+void stub_dict_begin(DictionaryIterator* iter, uint8_t* buffer) {
+  iter->dictionary = (Dictionary*)buffer;
+  iter->dictionary->count = 0;
+  iter->cursor = iter->dictionary->head;
+  iter->end = iter->cursor;
+}
+
+static Tuple* stub_dict_add(DictionaryIterator* iter, uint32_t key, TupleType type, const void* data, uint16_t length) {
+  Tuple* tuple = iter->cursor;
+  tuple->key = key;
+  tuple->type = type;
+  tuple->length = length;
+  memcpy(tuple->value->data, data, length);
+  iter->dictionary->count += 1;
+  iter->cursor = (Tuple*)(tuple->value->data + length);
+  iter->end = iter->cursor;
+  return tuple;
+}
+
+void stub_dict_add_cstring(DictionaryIterator* iter, uint32_t key, const char* cstring) {
+  stub_dict_add(iter, key, TUPLE_CSTRING, cstring, strlen(cstring) + 1);
+}
+
+void stub_dict_add_uint8(DictionaryIterator* iter, uint32_t key, uint8_t value) {
+  stub_dict_add(iter, key, TUPLE_UINT, &value, 1);
+}
+
+uint32_t dict_calc_buffer_size(const uint8_t tuple_count, ...) {
+  // One count byte, then a 7 byte header (key, type and length) before the
+  // value of each tuple.
+  uint32_t size = 1 + tuple_count * 7;
+  va_list sizes;
+  va_start(sizes, tuple_count);
+  for (uint8_t n = 0; n < tuple_count; n += 1) {
+    size += va_arg(sizes, uint32_t);
+  }
+  va_end(sizes);
+  return size;
+}
+
+DictionaryResult dict_write_int32(DictionaryIterator* iter, const uint32_t key, const int32_t value) {
+  stub_dict_add(iter, key, TUPLE_INT, &value, sizeof(value));
+  return DICT_OK;
+}
+
+DictionaryResult dict_write_uint8(DictionaryIterator* iter, const uint32_t key, const uint8_t value) {
+  stub_dict_add_uint8(iter, key, value);
+  return DICT_OK;
+}
+
+AppMessageResult app_message_outbox_begin(DictionaryIterator** iterator) {
+  stub_dict_begin(&stub_outbox, outbox_buffer);
+  *iterator = &stub_outbox;
+  return APP_MSG_OK;
+}
+
+AppMessageResult app_message_outbox_send(void) {
+  stub_outbox_sent += 1;
+  return APP_MSG_OK;
+}
+
+Tuple* dict_find(const DictionaryIterator* iter, const uint32_t key) {
+  uint8_t* pos = (uint8_t*)iter->dictionary->head;
+  for (uint8_t n = 0; n < iter->dictionary->count && (void*)pos < iter->end; n += 1) {
+    Tuple* tuple = (Tuple*)pos;
+    if (tuple->key == key) {
+      return tuple;
+    }
+    pos += sizeof(Tuple) + tuple->length;
+  }
+  return NULL;
+}
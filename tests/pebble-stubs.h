@@ -0,0 +1,24 @@
+#pragma once
+
+#include <pebble.h>
+
+// Value returned by the heap_bytes_free stub.
+extern size_t stub_heap_bytes_free;
+
+// Value returned by the time_ms stub, in milliseconds.
+extern uint32_t stub_time_ms;
+
+void stubs_reset(void);
+
+// Fires registered timers, including any they register, until none are left.
+// Returns the number of timers fired.
+int stub_app_timer_run_all(void);
+
+// Build a dictionary in buffer one tuple at a time.
+void stub_dict_begin(DictionaryIterator* iter, uint8_t* buffer);
+void stub_dict_add_cstring(DictionaryIterator* iter, uint32_t key, const char* cstring);
+void stub_dict_add_uint8(DictionaryIterator* iter, uint32_t key, uint8_t value);
+
+// The last message sent with app_message_outbox_send, and how many were sent.
+extern DictionaryIterator stub_outbox;
+extern int stub_outbox_sent;